@@ -1,6 +1,14 @@
 #pragma once
 #include "httplib.h"
+#include <string>
 
 void setup_routes(httplib::Server& app);
 
-void init_port_from_config();
\ No newline at end of file
+void init_port_from_config();
+
+// Расписание из CSV/NDJSON-файла вместо текущего; возвращает число судов.
+std::size_t load_schedule_file(const std::string& path, const std::string& format = "auto");
+
+// Каталог, из которого POST /schedule читает файлы (--data-dir). Пока он не
+// задан, загрузка файлов по HTTP выключена и остаётся только --schedule.
+void set_schedule_dir(const std::string& dir);
@@ -0,0 +1,62 @@
+#pragma once
+#include "json.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using json = nlohmann::json;
+
+// Автопрогон на отдельном потоке сервера. Раз в тик поток берёт
+// блокировку порта и делает stepsPerTick шагов; тики идут с такой частотой,
+// чтобы модельное время шло со скоростью speed минут модели в секунду, и от
+// клиентов не зависят — они только наблюдают (GET /events).
+// Тик делает не больше 1000 шагов: большие stepsPerTick и скорости, при
+// которых шагов за тик вышло бы больше, отклоняются (invalid_argument).
+//
+// Пауза проверяется под блокировкой порта, поэтому после pause, вызванного
+// под той же блокировкой, не выполнится ни одного шага.
+class AutoRunner {
+public:
+  struct Settings {
+    double speed = 60.0; // минут модели в секунду
+    int stepsPerTick = 1;
+
+    static Settings from_json(const json &j);
+  };
+
+  // step(n) делает n шагов под блокировкой порта и возвращает false, когда
+  // прогон закончен; тогда поток встаёт на паузу и вызывает stopped (тоже
+  // под блокировкой порта).
+  using Step = std::function<bool(int steps)>;
+
+  AutoRunner(std::mutex &portMutex, Step step, std::function<void()> stopped);
+  ~AutoRunner();
+
+  // stepMinutes — длина шага модели (config.step), из неё и speed
+  // получается интервал между тиками; повторный вызов меняет скорость
+  void start(const Settings &s, int stepMinutes);
+  void pause();
+  json status() const;
+
+private:
+  void run();
+
+  std::mutex &portMutex;
+  Step step;
+  std::function<void()> stopped;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  Settings settings;
+  // шагов за тик с учётом ограничения частоты тиков
+  int batch = 1;
+  std::chrono::steady_clock::duration interval{};
+  bool running = false;
+  bool quit = false;
+  // номер запуска: тик, начатый до pause/start, не выполняется
+  unsigned generation = 0;
+  long long ticks = 0;
+  std::thread worker;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Запись и чтение двоичных данных в буфер std::string. Числа пишутся как
+// есть (little-endian на всех целевых платформах), varint — для счётчиков и
+// разностей, где значения обычно малы.
+class BinaryWriter {
+public:
+  std::string buffer;
+
+  template <typename T> void put(T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "POD only");
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void putVarint(std::uint64_t v) {
+    while (v >= 0x80) {
+      buffer.push_back(char(v | 0x80));
+      v >>= 7;
+    }
+    buffer.push_back(char(v));
+  }
+
+  // zigzag: малые по модулю отрицательные числа тоже занимают один байт
+  void putSigned(std::int64_t v) {
+    putVarint((std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63));
+  }
+
+  void putString(const std::string &s) {
+    putVarint(s.size());
+    buffer.append(s);
+  }
+};
+
+class BinaryReader {
+public:
+  BinaryReader(const char *data, std::size_t size)
+      : start(data), p(data), end(data + size) {}
+  explicit BinaryReader(const std::string &s) : BinaryReader(s.data(), s.size()) {}
+
+  template <typename T> T get() {
+    static_assert(std::is_trivially_copyable<T>::value, "POD only");
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+  }
+
+  std::uint64_t getVarint() {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      need(1);
+      auto byte = (unsigned char)*p++;
+      v |= std::uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return v;
+    }
+    throw std::runtime_error("binary data: varint too long");
+  }
+
+  std::int64_t getSigned() {
+    std::uint64_t v = getVarint();
+    return std::int64_t(v >> 1) ^ -std::int64_t(v & 1);
+  }
+
+  std::string getString() {
+    std::uint64_t n = getVarint();
+    need(n);
+    std::string s(p, n);
+    p += n;
+    return s;
+  }
+
+  bool atEnd() const { return p == end; }
+  std::size_t position() const { return p - start; }
+
+private:
+  void need(std::uint64_t n) const {
+    if (n > std::uint64_t(end - p))
+      throw std::runtime_error("binary data: unexpected end");
+  }
+
+  const char *start;
+  const char *p;
+  const char *end;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "replication.hpp"
+#include "thread_pool.hpp"
+#include <vector>
+
+using json = nlohmann::json;
+
+// Парное сравнение двух конфигураций: i-я репликация обеих идёт с одним
+// зерном (общие случайные числа), поэтому разность B - A почти не содержит
+// шума от прибытий и разгрузок. С antithetic каждая пара дополняется
+// прогоном на 1 - u, наблюдение — среднее двух прогонов.
+// Пар ровно replications; параметры последовательной остановки
+// (targetHalfWidth, targetRelative, kpi, batch, maxReplications) отклоняются.
+//   {"a": {"cranesContainer": 1}, "b": {"cranesContainer": 2},
+//    "replications": 20, "antithetic": true}
+struct CompareOptions {
+  ReplicationOptions replication;
+  bool antithetic = false;
+
+  static CompareOptions from_json(const json &j);
+};
+
+struct KpiComparison {
+  SampleStats a;
+  SampleStats b;
+  // разность B - A по парам
+  SampleStats diff;
+  // полуширина интервала разности, если бы A и B шли с независимыми зёрнами
+  double independentHalfWidth = 0.0;
+
+  bool significant() const { return diff.ciLow > 0.0 || diff.ciHigh < 0.0; }
+  json to_json() const;
+};
+
+struct CompareResult {
+  int pairs = 0;
+  long long runs = 0;
+  double confidence = 0.95;
+  bool antithetic = false;
+  KpiComparison fine;
+  KpiComparison meanWait;
+  KpiComparison utilization;
+  KpiComparison makespan;
+
+  json to_json() const;
+};
+
+// Зёрна репликаций выводятся из a.seed и одинаковы для обеих конфигураций.
+// Расписание берётся из a, b с пустым расписанием использует его же.
+CompareResult compareConfigs(const SimulationConfig &a,
+                             const SimulationConfig &b,
+                             const CompareOptions &opt,
+                             ThreadPool &pool = ThreadPool::shared());
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "json.hpp"
@@ -11,7 +13,15 @@ namespace tmux {
     constexpr int DAY  = 24 * HOUR;
 }
 
-enum class CargoType { BULK, LIQUID, CONTAINER };
+enum class CargoType : std::uint8_t { BULK, LIQUID, CONTAINER };
+
+// FIXED_STEP — сдвиг времени на step с полным пересмотром судов и кранов,
+// NEXT_EVENT — переход сразу к ближайшему прибытию или окончанию разгрузки.
+enum class EngineMode { FIXED_STEP, NEXT_EVENT };
+
+// Какой из свободных кранов типа получает очередное судно: с меньшим номером,
+// дольше всех простаивающий или с наименьшей суммарной наработкой.
+enum class CranePolicy { LOWEST_INDEX, EARLIEST_FREED, LEAST_UTILIZED };
 
 struct SimulationConfig {
     int step = 15;
@@ -42,24 +52,19 @@ struct SimulationConfig {
     bool autoStart = false;
     int seed = 42;
 
-    json to_json() const {
-        json sched = json::array();
-        for (auto const& s : schedule) {
-            std::string t;
-            switch (s.type) {
-                case CargoType::BULK: t = "BULK"; break;
-                case CargoType::LIQUID: t = "LIQUID"; break;
-                case CargoType::CONTAINER: t = "CONTAINER"; break;
-            }
-            sched.push_back({
-                {"name", s.name},
-                {"type", t},
-                {"arrival", s.arrival},
-                {"weight", s.weight}
-            });
+    EngineMode engine = EngineMode::FIXED_STEP;
+    CranePolicy cranePolicy = CranePolicy::LOWEST_INDEX;
+
+    // withSchedule = false — без расписания (оно может быть на миллионы судов)
+    json to_json(bool withSchedule = true) const {
+        std::string policy;
+        switch (cranePolicy) {
+            case CranePolicy::LOWEST_INDEX: policy = "LOWEST_INDEX"; break;
+            case CranePolicy::EARLIEST_FREED: policy = "EARLIEST_FREED"; break;
+            case CranePolicy::LEAST_UTILIZED: policy = "LEAST_UTILIZED"; break;
         }
 
-        return {
+        json j = {
             {"seed", seed},
             {"step", step},
             {"cranesBulk", cranesBulk},
@@ -75,8 +80,28 @@ struct SimulationConfig {
             {"finePerMinute", finePerMinute},
             {"autoStart", autoStart},
             {"seed", seed},
-            {"schedule", sched}
+            {"engine", engine == EngineMode::NEXT_EVENT ? "NEXT_EVENT" : "FIXED_STEP"},
+            {"cranePolicy", policy}
         };
+        if (withSchedule) {
+            json sched = json::array();
+            for (auto const& s : schedule) {
+                std::string t;
+                switch (s.type) {
+                    case CargoType::BULK: t = "BULK"; break;
+                    case CargoType::LIQUID: t = "LIQUID"; break;
+                    case CargoType::CONTAINER: t = "CONTAINER"; break;
+                }
+                sched.push_back({
+                    {"name", s.name},
+                    {"type", t},
+                    {"arrival", s.arrival},
+                    {"weight", s.weight}
+                });
+            }
+            j["schedule"] = std::move(sched);
+        }
+        return j;
     }
 
     static SimulationConfig from_json(const json& j) {
@@ -97,6 +122,25 @@ struct SimulationConfig {
         if (j.contains("finePerMinute")) c.finePerMinute = j["finePerMinute"];
         if (j.contains("autoStart")) c.autoStart = j["autoStart"];
         if (j.contains("seed")) c.seed = j["seed"];
+        if (j.contains("engine")) {
+            std::string e = j["engine"];
+            c.engine = (e == "NEXT_EVENT") ? EngineMode::NEXT_EVENT : EngineMode::FIXED_STEP;
+        }
+        if (j.contains("cranePolicy")) {
+            std::string p = j["cranePolicy"];
+            if (p == "EARLIEST_FREED") c.cranePolicy = CranePolicy::EARLIEST_FREED;
+            else if (p == "LEAST_UTILIZED") c.cranePolicy = CranePolicy::LEAST_UTILIZED;
+            else c.cranePolicy = CranePolicy::LOWEST_INDEX;
+        }
+
+        // при step <= 0 прогон не двигал бы время, а при нуле кранов или
+        // нулевой скорости разгрузки суда ждали бы вечно
+        if (c.step <= 0)
+            throw std::invalid_argument("step must be positive");
+        if (c.cranesBulk <= 0 || c.cranesLiquid <= 0 || c.cranesContainer <= 0)
+            throw std::invalid_argument("crane counts must be positive");
+        if (!(c.rateBulk > 0) || !(c.rateLiquid > 0) || !(c.rateContainer > 0))
+            throw std::invalid_argument("unload rates must be positive");
 
         c.schedule.clear();
         if (j.contains("schedule")) {
@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Вектор из блоков по 2^ChunkBits элементов с копированием при записи.
+// Копия CowVector копирует только таблицу указателей на блоки: копии делят
+// все блоки, а блок дублируется при первой записи через mut() в том
+// экземпляре, который его меняет. Чтение — через operator[] const.
+//
+// Разные копии можно читать и менять из разных потоков; один экземпляр —
+// как обычный std::vector, без синхронизации.
+template <typename T, unsigned ChunkBits = 10> class CowVector {
+public:
+  static constexpr std::size_t kChunk = std::size_t(1) << ChunkBits;
+  using Chunk = std::array<T, kChunk>;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    const_iterator() = default;
+    const_iterator(const CowVector *v, std::size_t i) : v(v), i(i) {}
+    reference operator*() const { return (*v)[i]; }
+    pointer operator->() const { return &(*v)[i]; }
+    const_iterator &operator++() {
+      ++i;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++i;
+      return old;
+    }
+    bool operator==(const const_iterator &o) const { return i == o.i; }
+    bool operator!=(const const_iterator &o) const { return i != o.i; }
+
+  private:
+    const CowVector *v = nullptr;
+    std::size_t i = 0;
+  };
+
+  CowVector() = default;
+  CowVector(const std::vector<T> &items) {
+    reserve(items.size());
+    for (auto const &x : items)
+      push_back(x);
+  }
+
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  const T &operator[](std::size_t i) const {
+    return (*chunks[i >> ChunkBits])[i & (kChunk - 1)];
+  }
+
+  // доступ на запись: блок, общий с другими копиями, сначала дублируется
+  T &mut(std::size_t i) { return (*own(i >> ChunkBits))[i & (kChunk - 1)]; }
+
+  void push_back(T value) {
+    if ((count & (kChunk - 1)) == 0)
+      chunks.push_back(std::make_shared<Chunk>());
+    mut(count) = std::move(value);
+    ++count;
+  }
+
+  void clear() {
+    chunks.clear();
+    count = 0;
+  }
+
+  void reserve(std::size_t n) { chunks.reserve((n + kChunk - 1) >> ChunkBits); }
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, count}; }
+
+  // число блоков, которые этот экземпляр делит с другими копиями
+  std::size_t sharedChunks() const {
+    std::size_t n = 0;
+    for (auto const &c : chunks)
+      n += c.use_count() > 1;
+    return n;
+  }
+  std::size_t chunkCount() const { return chunks.size(); }
+
+private:
+  Chunk *own(std::size_t c) {
+    auto &p = chunks[c];
+    if (p.use_count() != 1) {
+      p = std::make_shared<Chunk>(*p);
+    } else {
+      // последняя чужая ссылка могла исчезнуть в другом потоке: её записи
+      // в блок должны быть видны до наших
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return p.get();
+  }
+
+  std::vector<std::shared_ptr<Chunk>> chunks;
+  std::size_t count = 0;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "binary_io.hpp"
+#include "config.hpp"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Port;
+
+// Типы записей журнала.
+enum class JournalEvent : std::uint8_t { ARRIVE, ASSIGN, FINISH, FINE };
+
+// Двоичный журнал событий прогона, только дозапись. Заголовок содержит
+// конфигурацию (без расписания) и снимок Port сразу после reset, далее идут
+// записи: байт типа, varint-приращение времени от предыдущей записи и
+// номера судна/крана; для штрафа — число минут, за которые он начислен
+// (суммы восстанавливаются по очередям). FINISH пишется в момент
+// освобождения крана.
+//
+// Пока журнал пишется, он хранит опорные кадры — копии Port на границах
+// шагов не реже чем через keyframeEvery записей (копии дешёвые: блоки судов
+// общие с живым портом). Состояние на любой прошедший момент строится из
+// ближайшего кадра и не более keyframeEvery записей (плюс записи одного шага).
+//
+// Память ограничена. Кадров не больше maxKeyframes: при переполнении
+// остаётся каждый второй, а интервал между ними удваивается. Когда записи
+// занимают maxBytes, журнал в конце шага закрывается (full): дальнейшие
+// события не пишутся, data() остаётся корректным журналом до момента
+// fullAt(), а stateAt для более поздних моментов бросает std::out_of_range.
+// Следующий begin (reset, restore) начинает журнал заново.
+class EventJournal {
+public:
+  std::size_t keyframeEvery = 256;
+  std::size_t maxKeyframes = 1024;
+  std::size_t maxBytes = std::size_t(64) << 20;
+
+  void begin(const Port &port);
+  // вызывается портом в конце шага
+  void checkpoint(const Port &port);
+  // состояние на момент t (не позже последнего шага) в out
+  void stateAt(int t, Port &state) const;
+  std::size_t keyframes() const { return frames.size(); }
+  bool full() const { return closed; }
+  int fullAt() const { return closedAt; }
+
+  void arrive(int t, int ship);
+  void assign(int t, int ship, int crane);
+  void finish(int t, int ship, int crane);
+  void fine(int t, int minutes);
+
+  const std::string &data() const { return out.buffer; }
+  std::size_t events() const { return count; }
+  bool empty() const { return out.buffer.empty(); }
+
+private:
+  struct Keyframe {
+    int time;
+    std::size_t event;
+    std::size_t offset;
+    int lastRecord;
+    std::shared_ptr<const Port> port;
+  };
+
+  void stamp(JournalEvent e, int t);
+  void capture(const Port &port);
+
+  BinaryWriter out;
+  int last = 0;
+  std::size_t count = 0;
+  std::vector<Keyframe> frames;
+  // текущий интервал между кадрами: keyframeEvery, удвоенный прореживаниями
+  std::size_t every = 0;
+  bool closed = false;
+  int closedAt = 0;
+};
+
+// Воспроизведение журнала: состояние после первых n записей строится
+// применением записей к снимку из заголовка, без генератора случайных чисел
+// и логики назначения кранов. Port, в который идёт воспроизведение,
+// ссылается на config() и не должен переживать JournalReplayer.
+class JournalReplayer {
+public:
+  explicit JournalReplayer(std::string journal);
+
+  const SimulationConfig &config() const { return cfg; }
+  std::size_t eventCount() const { return count; }
+
+  // возвращает число применённых записей
+  std::size_t replay(Port &port,
+                     std::size_t events = std::numeric_limits<std::size_t>::max()) const;
+
+private:
+  std::string data;
+  SimulationConfig cfg;
+  std::string initial;
+  std::size_t bodyOffset = 0;
+  std::size_t count = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include "config.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Вызовы SEAPORT_LOG ниже этого уровня не компилируются
+// (задаётся в CMake: -DSEAPORT_LOG_LEVEL=INFO, OFF — без логов вообще).
+#ifndef SEAPORT_LOG_LEVEL
+#define SEAPORT_LOG_LEVEL 0
+#endif
+
+enum class LogLevel : std::uint8_t { TRACE, DEBUG, INFO, WARN, ERR, OFF };
+
+// SEAPORT_LOG_LEVEL как LogLevel: сравнение уровней в SEAPORT_LOG идёт без
+// приведения к int (иначе при уровне 0 срабатывает -Wtype-limits)
+inline constexpr LogLevel kCompiledLogLevel =
+    static_cast<LogLevel>(SEAPORT_LOG_LEVEL);
+
+LogLevel logLevelFromName(const std::string &name);
+const char *logLevelName(LogLevel level);
+
+enum class LogEvent : std::uint8_t {
+  MESSAGE,
+  ARRIVE,
+  ASSIGN,
+  FINISH,
+  FINE,
+  REQUEST
+};
+
+// Запись фиксированного размера: в горячем пути поля только копируются,
+// форматирование и вывод — в фоновом потоке. Длинные строки обрезаются.
+struct LogRecord {
+  LogLevel level = LogLevel::INFO;
+  LogEvent event = LogEvent::MESSAGE;
+  CargoType cargo = CargoType::BULK;
+  int time = 0;
+  int until = 0;       // ASSIGN — конец разгрузки, REQUEST — код ответа
+  double amount = 0.0; // FINE — штраф, REQUEST — длительность, мс
+  double total = 0.0;
+  std::int64_t wall = 0; // мс от эпохи system_clock
+  char name[32] = {};    // судно или HTTP-метод
+  char text[160] = {};   // сообщение или путь
+
+  static LogRecord message(std::string_view text);
+  static LogRecord arrival(int t, std::string_view ship, CargoType type);
+  static LogRecord assign(int t, std::string_view ship, CargoType type,
+                          int until);
+  static LogRecord finish(int t, std::string_view ship, CargoType type);
+  static LogRecord fine(int t, double amount, double total);
+  static LogRecord request(std::string_view method, std::string_view path,
+                           int status, double ms);
+};
+
+// Приёмник записей; вызывается только из потока записи.
+class LogSink {
+public:
+  virtual ~LogSink() = default;
+  virtual void write(const LogRecord &rec) = 0;
+  // конец пачки записей
+  virtual void flush() = 0;
+};
+
+// Текст в прежнем виде, с цветами терминала или без.
+class TextSink : public LogSink {
+public:
+  explicit TextSink(std::ostream &out = std::cout, bool color = true)
+      : out(out), color(color) {}
+  void write(const LogRecord &rec) override;
+  void flush() override;
+
+private:
+  std::ostream &out;
+  bool color;
+  std::string buffer;
+};
+
+// По JSON-объекту на строку.
+class JsonSink : public LogSink {
+public:
+  explicit JsonSink(std::ostream &out = std::cout) : out(out) {}
+  void write(const LogRecord &rec) override;
+  void flush() override;
+
+private:
+  std::ostream &out;
+  std::string buffer;
+};
+
+// Асинхронный лог: производители кладут записи в ограниченное кольцо без
+// блокировок (ячейки с номерами последовательности, как в очереди Вьюкова),
+// единственный фоновый поток вынимает их пачками и отдаёт приёмнику. При
+// переполнении запись отбрасывается и учитывается в dropped() — симуляция
+// никогда не ждёт вывода.
+class Logger {
+public:
+  static constexpr std::size_t kCapacity = 8192;
+
+  static Logger &get();
+
+  bool enabled(LogLevel l) const {
+    return l >= level.load(std::memory_order_relaxed);
+  }
+  void setLevel(LogLevel l) { level.store(l, std::memory_order_relaxed); }
+  void setSink(std::unique_ptr<LogSink> s);
+
+  void push(LogLevel l, const LogRecord &rec);
+  // ждёт, пока всё положенное до вызова будет выведено
+  void flush();
+  std::uint64_t dropped() const {
+    return droppedCount.load(std::memory_order_relaxed);
+  }
+
+  ~Logger();
+
+private:
+  struct Cell {
+    std::atomic<std::uint64_t> seq;
+    LogRecord rec;
+  };
+
+  Logger();
+  bool pop(LogRecord &rec);
+  void run();
+
+  std::unique_ptr<Cell[]> ring;
+  alignas(64) std::atomic<std::uint64_t> head{0};
+  alignas(64) std::atomic<std::uint64_t> tail{0};
+  std::atomic<std::uint64_t> written{0};
+  std::atomic<std::uint64_t> droppedCount{0};
+  std::atomic<LogLevel> level{LogLevel::DEBUG};
+  std::atomic<bool> stop{false};
+
+  std::mutex sinkMutex;
+  std::unique_ptr<LogSink> sink;
+  std::thread writer;
+};
+
+#define SEAPORT_LOG(LEVEL, ...)                                                \
+  do {                                                                         \
+    if constexpr (LogLevel::LEVEL >= kCompiledLogLevel) {                      \
+      if (Logger::get().enabled(LogLevel::LEVEL))                              \
+        Logger::get().push(LogLevel::LEVEL, __VA_ARGS__);                      \
+    }                                                                          \
+  } while (0)
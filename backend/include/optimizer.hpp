@@ -0,0 +1,72 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "replication.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Поиск самого дешёвого набора кранов, при котором ожидаемый штраф не
+// превышает бюджет:
+//   {"fineBudget": 90000,
+//    "bounds": {"BULK": [1, 4], "LIQUID": [1, 4], "CONTAINER": [1, 4]},
+//    "craneCost": {"BULK": 1, "LIQUID": 1, "CONTAINER": 1.5},
+//    "batch": 5, "maxReplications": 40, "confidence": 0.95}
+struct OptimizeSpec {
+  double fineBudget = 0.0;
+  int minCranes[3] = {1, 1, 1};
+  int maxCranes[3] = {4, 4, 4};
+  double craneCost[3] = {1.0, 1.0, 1.0};
+  int batch = 5;
+  int maxReplications = 40;
+  double confidence = 0.95;
+  int until = std::numeric_limits<int>::max();
+
+  static OptimizeSpec from_json(const json &j);
+};
+
+// UNRESOLVED — maxReplications исчерпаны, а доверительный интервал штрафа
+// всё ещё накрывает бюджет: кандидат не принимается и ничего не отсекает.
+enum class CandidateStatus { FEASIBLE, INFEASIBLE, DOMINATED, UNRESOLVED };
+
+struct CandidateResult {
+  int cranes[3] = {0, 0, 0};
+  double cost = 0.0;
+  CandidateStatus status = CandidateStatus::DOMINATED;
+  SampleStats fine;
+
+  json to_json() const;
+};
+
+struct OptimizeResult {
+  bool found = false;
+  CandidateResult best;
+  int candidates = 0;
+  int evaluated = 0;
+  int pruned = 0;
+  long long replications = 0;
+  std::vector<CandidateResult> history;
+
+  json to_json() const;
+};
+
+// Кандидаты перебираются по возрастанию стоимости волнами по числу потоков.
+// Репликации каждого кандидата идут пачками по spec.batch: кандидат
+// отбрасывается, как только нижняя граница доверительного интервала штрафа
+// превысила бюджет, и принимается, когда верхняя опустилась ниже. Если
+// кандидат не проходит, то не проходят и все наборы с не большим числом
+// кранов каждого типа — они отсекаются без прогонов; после первого
+// подходящего отсекаются все более дорогие. Границы числа кранов — от 1;
+// кандидат, хотя бы один прогон которого встал до until с неразгруженными
+// судами, не проходит.
+OptimizeResult
+optimizeCranes(const SimulationConfig &base, const OptimizeSpec &spec,
+               const std::function<void(const CandidateResult &)> &onCandidate =
+                   nullptr,
+               const std::atomic<bool> *cancel = nullptr,
+               ThreadPool &pool = ThreadPool::shared());
@@ -1,57 +1,171 @@
 #pragma once
 #include "config.hpp"
+#include "cow_vector.hpp"
 #include "json.hpp"
-#include <optional>
+#include "rng.hpp"
+#include "ship_store.hpp"
 #include <queue>
-#include <random>
 #include <string>
 #include <vector>
 
 using json = nlohmann::json;
 
-struct Ship {
-  std::string name;
-  CargoType type;
-  int arrival = 0;
-  int actualArrival = 0;
-  int weight = 0;
-  int unloadTime = 0;
-  bool inQueue = false;
-  bool unloading = false;
-  bool finished = false;
-  bool assigned = false;
-  std::optional<int> startUnload;
-  std::optional<int> finish;
-};
+class EventJournal;
+class TraceWriter;
 
 struct Crane {
   CargoType type;
   bool busy = false;
   int busyUntil = 0;
+  long long busyMinutes = 0;
+  // версия Port при последнем изменении крана
+  std::uint64_t version = 0;
+};
+
+// Запланированное окончание разгрузки: судно ship освобождает кран crane
+// в момент time. Прибытия дают курсор по судам, отсортированным по
+// actualArrival, так что вместе они образуют список будущих событий.
+struct Completion {
+  int time;
+  int ship;
+  int crane;
+
+  bool operator>(const Completion &other) const {
+    if (time != other.time)
+      return time > other.time;
+    return ship > other.ship;
+  }
+};
+
+// Итоговые показатели прогона; ожидание — от фактического прибытия до начала
+// разгрузки, загрузка кранов — доля занятых крано-минут от now.
+struct RunSummary {
+  struct TypeStats {
+    int ships = 0;
+    int served = 0;
+    long long totalWait = 0;
+    int maxWait = 0;
+    int cranes = 0;
+    long long busyMinutes = 0;
+
+    double meanWait() const { return served ? (double)totalWait / served : 0.0; }
+    double utilization(int now) const {
+      return (cranes > 0 && now > 0) ? (double)busyMinutes / ((double)cranes * now) : 0.0;
+    }
+  };
+
+  int now = 0;
+  double fine = 0.0;
+  int makespan = 0;
+  int shipsTotal = 0;
+  int shipsFinished = 0;
+  long long events = 0;
+  bool completed = false;
+  TypeStats byType[3];
+
+  double meanWait() const;
+  double utilization() const;
+  json to_json() const;
 };
 
 class Port {
 public:
   int now = 0;
   double fine = 0.0;
-  SimulationConfig *cfg = nullptr;
+  double fineByType[3] = {0.0, 0.0, 0.0};
+  const SimulationConfig *cfg = nullptr;
+  // расписание, общее для нескольких прогонов; если не задано — cfg->schedule
+  const std::vector<SimulationConfig::ShipPlan> *plans = nullptr;
+
+  ShipStore ships;
+  CowVector<Crane> cranes;
+
+  ShipQueue qBulk, qLiquid, qContainer;
+  // зерно счётчикового генератора (rng.hpp)
+  std::uint64_t rngSeed = 0;
+  // антитетический прогон: каждая выборка u заменяется на 1 - u
+  bool antithetic = false;
+
+  std::priority_queue<Completion, std::vector<Completion>, std::greater<>>
+      completions;
 
-  std::vector<Ship> ships;
-  std::vector<Crane> cranes;
+  CowVector<int> arrivalOrder;
+  std::size_t arrivalCursor = 0;
 
-  std::queue<int> qBulk, qLiquid, qContainer;
-  std::mt19937 rng{std::random_device{}()};
+  // Номер версии состояния, растёт с каждым шагом и изменением модели.
+  // Суда и краны помнят версию, в которой менялись; layoutVersion — версия
+  // последней перестройки (reset, restore, смена кранов), после которой
+  // клиенту нужно полное состояние.
+  std::uint64_t version = 0;
+  std::uint64_t layoutVersion = 0;
 
-  void setConfig(SimulationConfig *c);
+  bool logEvents = true;
+  // журнал событий (journal.hpp); reset начинает его заново
+  EventJournal *journal = nullptr;
+  // трасса для просмотрщика (trace.hpp); reset пишет её заголовок
+  TraceWriter *trace = nullptr;
+
+  void setConfig(const SimulationConfig *c);
+  void reseed(unsigned seed);
+  void setSchedule(const std::vector<SimulationConfig::ShipPlan> *schedule);
   void reset();
   void simulateStep(int delta);
-  json getState() const;
+  bool advanceToNextEvent(int limit);
+  void advanceTo(int target);
+  int nextEventTime() const;
+  long long run(int until, long long maxEvents);
+  bool done() const;
+  bool stalled() const;
+  RunSummary summarize() const;
+  // since > 0 — только суда и краны, изменившиеся после версии since
+  // (или всё, если с тех пор состояние перестраивалось)
+  json getState(std::uint64_t since = 0) const;
+
+  // Двоичный снимок всего состояния модели (snapshot.cpp). Конфигурация в
+  // снимок не входит: перед restore её задают через setConfig.
+  std::string snapshot() const;
+  void restore(const std::string &data);
+  // Смена конфигурации посреди прогона: число кранов доводится до нового
+  // (убирать можно только свободные краны), время разгрузки ещё не начатых
+  // судов пересчитывается, фактические прибытия остаются прежними.
+  void reconfigure(const SimulationConfig *c);
+
+  // Применение записей журнала без логики модели (journal.cpp).
+  void applyArrival(int t, int ship);
+  void applyAssign(int t, int ship, int crane);
+  void applyFinish(int t, int ship, int crane);
+  void applyFine(int t, int minutes);
 
 private:
-  int randomJitter(int left, int right);
-  int computeUnloadTime(const Ship &ship);
+  double draw(std::uint64_t shipKey, DrawPurpose purpose) const;
+  int computeUnloadTime(CargoType type, int weight, std::uint64_t shipKey);
   void enqueueArrivals();
   void tryAssignCranes();
+  void releaseCranes();
+  void releaseCrane(int ci);
+  ShipQueue &queueFor(CargoType t);
   void completeFinished();
-  void accrueFine();
+  double accrueFine(int minutes);
+  void logFine(double amount) const;
+  void touchShip(int idx) { ships.version.mut(idx) = version; }
+  void arrive(int idx);
+  void finishUnload(int idx);
+  int waitingCount() const;
+  void sortArrivals();
+  void rebuildFreeCranes();
+  // restore: счётчики сходятся с состояниями судов и очередями
+  void checkRestoredCounters() const;
+
+  std::vector<int> arrivalBatch;
+  std::vector<int> finishedBatch;
+  int waiting[3] = {0, 0, 0};
+
+  // свободные краны по типам; ключ задаёт cfg->cranePolicy, при равенстве
+  // ключей выбирается кран с меньшим номером
+  using CranePool =
+      std::priority_queue<std::pair<long long, int>,
+                          std::vector<std::pair<long long, int>>, std::greater<>>;
+  CranePool freeCranes[3];
+  int startedCount = 0;
+  int finishedCount = 0;
 };
@@ -0,0 +1,98 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "port.hpp"
+#include "thread_pool.hpp"
+#include <limits>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Показатели прогона, по которым считается статистика репликаций.
+enum class Kpi { FINE, MEAN_WAIT, UTILIZATION, MAKESPAN };
+
+double kpiValue(const RunSummary &run, Kpi kpi);
+const char *kpiName(Kpi kpi);
+Kpi kpiFromName(const std::string &name);
+
+// Выборочная статистика показателя: среднее, стандартное отклонение,
+// доверительный интервал по Стьюденту и перцентили.
+struct SampleStats {
+  int n = 0;
+  double mean = 0.0;
+  double stddev = 0.0;
+  double halfWidth = 0.0;
+  double ciLow = 0.0;
+  double ciHigh = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double p5 = 0.0;
+  double p25 = 0.0;
+  double p50 = 0.0;
+  double p75 = 0.0;
+  double p95 = 0.0;
+
+  json to_json() const;
+};
+
+double studentQuantile(double p, int df);
+SampleStats computeStats(std::vector<double> samples, double confidence);
+
+// Если задана целевая полуширина интервала (абсолютная targetHalfWidth или
+// относительная targetRelative — доля среднего), репликации запускаются
+// пачками по batch до её достижения по показателю kpi, но не больше
+// maxReplications; replications тогда — минимальное число прогонов.
+// replications, batch и maxReplications больше kMaxReplications
+// отклоняются (invalid_argument).
+//   {"targetRelative": 0.05, "kpi": "fine", "maxReplications": 500}
+struct ReplicationOptions {
+  static constexpr int kMaxReplications = 10000;
+
+  int replications = 30;
+  double confidence = 0.95;
+  int until = std::numeric_limits<int>::max();
+
+  double targetHalfWidth = 0.0;
+  double targetRelative = 0.0;
+  Kpi kpi = Kpi::FINE;
+  int batch = 0; // 0 — по числу потоков пула
+  int maxReplications = 1000;
+
+  bool sequential() const { return targetHalfWidth > 0 || targetRelative > 0; }
+  bool targetReached(const SampleStats &st) const;
+  static ReplicationOptions from_json(const json &j);
+};
+
+// invalid_argument, если value больше ReplicationOptions::kMaxReplications;
+// name — имя поля запроса для сообщения.
+void checkReplicationLimit(const char *name, int value);
+
+struct ReplicationResult {
+  int replications = 0;
+  double confidence = 0.95;
+  // заполняются только при последовательной остановке
+  bool sequential = false;
+  bool converged = false;
+  SampleStats fine;
+  SampleStats meanWait;
+  SampleStats utilization;
+  SampleStats makespan;
+
+  json to_json() const;
+};
+
+// Зерно i-й репликации выводится из cfg.seed, так что набор репликаций
+// воспроизводим и не зависит от числа потоков.
+unsigned replicationSeed(int baseSeed, int replication);
+
+RunSummary runReplication(
+    const SimulationConfig &cfg, unsigned seed, int until,
+    const std::vector<SimulationConfig::ShipPlan> *schedule = nullptr,
+    bool antithetic = false);
+
+ReplicationResult summarizeReplications(const std::vector<RunSummary> &runs,
+                                        double confidence);
+
+ReplicationResult replicate(const SimulationConfig &cfg,
+                            const ReplicationOptions &opt,
+                            ThreadPool &pool = ThreadPool::shared());
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Счётчиковый генератор Philox4x32-10 (Salmon et al., 2011): случайное число
+// вычисляется по ключу и номеру, без общего состояния. Поток задаётся
+// тройкой (зерно, судно, назначение), поэтому выборки судна не зависят от
+// того, какие суда стоят в расписании до него и в каком порядке они
+// разыгрываются.
+namespace philox {
+
+using Counter = std::array<std::uint32_t, 4>;
+using Key = std::array<std::uint32_t, 2>;
+
+inline Counter block(Counter c, Key k) {
+  constexpr std::uint64_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  constexpr std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t p0 = M0 * c[0];
+    std::uint64_t p1 = M1 * c[2];
+    c = {std::uint32_t(p1 >> 32) ^ c[1] ^ k[0], std::uint32_t(p1),
+         std::uint32_t(p0 >> 32) ^ c[3] ^ k[1], std::uint32_t(p0)};
+    k[0] += W0;
+    k[1] += W1;
+  }
+  return c;
+}
+
+} // namespace philox
+
+// Назначение выборки: у каждого своя независимая последовательность.
+enum class DrawPurpose : std::uint32_t {
+  ARRIVAL_JITTER,
+  UNLOAD_EXTRA,
+  SCHEDULE // генератор расписаний
+};
+
+struct RandomStream {
+  std::uint64_t seed = 0;
+  std::uint64_t ship = 0;
+  DrawPurpose purpose = DrawPurpose::ARRIVAL_JITTER;
+
+  // n-е равномерное число из (0, 1)
+  double uniform(std::uint32_t n = 0) const {
+    auto r = philox::block({(std::uint32_t)purpose, n, std::uint32_t(ship),
+                            std::uint32_t(ship >> 32)},
+                           {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+    std::uint64_t bits = (std::uint64_t(r[0]) << 21) ^ (r[1] >> 11);
+    return (double(bits & ((1ull << 53) - 1)) + 0.5) * 0x1.0p-53;
+  }
+};
+
+// Целое из [left, right] по равномерному u из (0, 1).
+inline int uniformInt(double u, int left, int right) {
+  if (left > right)
+    std::swap(left, right);
+  long long span = (long long)right - left + 1;
+  long long k = (long long)(u * (double)span);
+  return (int)(left + (k < span ? k : span - 1));
+}
+
+// Ключ судна для RandomStream: строится по его плану (FNV-1a), а не по
+// позиции в расписании. Суда с одинаковыми планами получают одинаковые
+// выборки.
+inline std::uint64_t shipStreamKey(const std::string &name, int arrival,
+                                   int weight, int type) {
+  std::uint64_t h = 0xcbf29ce484222325ull;
+  auto mix = [&h](std::uint64_t byte) {
+    h ^= byte;
+    h *= 0x100000001b3ull;
+  };
+  for (unsigned char ch : name)
+    mix(ch);
+  for (int v : {arrival, weight, type}) {
+    for (int b = 0; b < 4; ++b)
+      mix((std::uint32_t(v) >> (8 * b)) & 0xff);
+  }
+  return h;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Процесс прибытий одного потока судов. Интенсивности — судов (пачек) в сутки.
+//   {"process": "poisson", "perDay": 40}
+//   {"process": "piecewise", "period": 1440,
+//    "segments": [{"from": 0, "perDay": 10}, {"from": 480, "perDay": 60}]}
+//   {"process": "batch", "perDay": 2, "batchSize": [3, 8], "spread": 30}
+// piecewise: интенсивность постоянна от from до следующего сегмента; с period
+// сегменты повторяются (сезонность), без него последний действует до конца.
+// batch: пачки приходят по Пуассону, в пачке от batchSize[0] до batchSize[1]
+// судов, каждое — в пределах spread минут от начала пачки.
+struct ArrivalProcess {
+  enum Kind { POISSON, PIECEWISE, BATCH };
+  struct Segment {
+    int from = 0;
+    double perDay = 0.0;
+  };
+
+  Kind kind = Kind::POISSON;
+  double perDay = 1.0;
+  std::vector<Segment> segments;
+  int period = 0;
+  int batchMin = 1;
+  int batchMax = 1;
+  int spread = 0;
+
+  static ArrivalProcess from_json(const json &j);
+  // интенсивность в момент t, судов (пачек) в минуту
+  double rateAt(int t) const;
+  // ближайшая смена интенсивности после t
+  int nextChange(int t) const;
+};
+
+// Распределение веса груза.
+//   {"distribution": "lognormal", "median": 250000, "sigma": 0.3}
+//   {"distribution": "empirical", "values": [200000, 300000],
+//    "probabilities": [0.7, 0.3]}
+// Вместо median можно задать mu = ln(median). Без probabilities значения
+// равновероятны. min/max ограничивают результат.
+struct WeightDistribution {
+  enum Kind { LOGNORMAL, EMPIRICAL };
+
+  Kind kind = Kind::LOGNORMAL;
+  double mu = 0.0;
+  double sigma = 0.0;
+  std::vector<int> values;
+  std::vector<double> cumulative;
+  int min = 1;
+  int max = std::numeric_limits<int>::max();
+
+  static WeightDistribution from_json(const json &j);
+  // вес по двум равномерным числам из (0, 1)
+  int sample(double u1, double u2) const;
+};
+
+// Поток судов одного типа груза.
+struct CargoStream {
+  CargoType type = CargoType::CONTAINER;
+  std::string prefix;
+  ArrivalProcess arrivals;
+  WeightDistribution weights;
+};
+
+// {"seed": 7, "horizon": 43200, "streams": [{"type": "CONTAINER",
+//   "prefix": "C", "arrivals": {...}, "weight": {...}}]}
+// Горизонт — не больше kMaxHorizon, а ожидаемое число судов (наибольшая
+// интенсивность потока × горизонт × наибольшая пачка, по всем потокам) —
+// не больше kMaxShips; иначе from_json бросает invalid_argument.
+struct ScheduleSpec {
+  static constexpr int kMaxHorizon = 3650 * tmux::DAY;
+  static constexpr double kMaxShips = 2e6;
+
+  std::uint64_t seed = 42;
+  int horizon = 30 * tmux::DAY;
+  std::vector<CargoStream> streams;
+
+  static ScheduleSpec from_json(const json &j);
+};
+
+// Синтетическое расписание на [0, horizon). Горизонт делится на сутки, каждые
+// сутки разыгрываются отдельной задачей пула со своими потоками Philox
+// (зерно, поток, сутки), поэтому результат зависит только от spec, а не от
+// числа потоков. Суда идут по суткам, внутри суток — по времени прибытия;
+// судно пачки, заходящее за полночь, остаётся в сутках пачки. Имена —
+// "<prefix>-<сутки>-<номер>"; префиксы потоков различны (по умолчанию —
+// буква типа, у второго потока того же типа — с номером потока: "B1").
+std::vector<SimulationConfig::ShipPlan>
+generateSchedule(const ScheduleSpec &spec,
+                 ThreadPool &pool = ThreadPool::shared());
@@ -0,0 +1,25 @@
+#pragma once
+#include "config.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <vector>
+
+// Формат файла расписания. AUTO — по расширению (.csv / .ndjson, .jsonl).
+enum class ScheduleFormat { AUTO, CSV, NDJSON };
+
+ScheduleFormat scheduleFormatFromName(const std::string &name);
+
+// Загрузка расписания из файла без промежуточного JSON-дерева: файл
+// отображается в память (mmap), делится на куски по границам строк, куски
+// разбираются параллельно прямо в ShipPlan и склеиваются в исходном порядке.
+//
+// CSV: столбцы name,type,arrival,weight; первая строка — заголовок, если
+// состоит из этих имён (тогда порядок столбцов берётся из неё). Имя можно
+// взять в двойные кавычки.
+// NDJSON: по объекту {"name", "type", "arrival", "weight"} на строку.
+// Пустые строки пропускаются; при ошибке бросается std::runtime_error с
+// номером строки. Путь в сообщения не попадает (их видит клиент POST
+// /schedule) — имя файла добавляет вызывающий.
+std::vector<SimulationConfig::ShipPlan>
+loadSchedule(const std::string &path, ScheduleFormat format = ScheduleFormat::AUTO,
+             ThreadPool &pool = ThreadPool::shared());
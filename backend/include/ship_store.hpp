@@ -0,0 +1,96 @@
+#pragma once
+#include "config.hpp"
+#include "cow_vector.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Жизненный цикл судна: переходы только вперёд, по одному на событие.
+enum class ShipState : std::uint8_t { EN_ROUTE, QUEUED, UNLOADING, FINISHED };
+
+constexpr int kNoTime = -1;
+
+// Холодные данные судна из расписания: цикл симуляции их не читает.
+struct ShipInfo {
+  std::string name;
+  int arrival = 0;
+  int weight = 0;
+};
+
+// Суда в виде структуры массивов: фазы шага читают только плотные массивы
+// времён, состояний и типов, имена и плановые данные лежат отдельно в info.
+// Индекс судна во всех массивах — его id. Массивы копируются при записи
+// (cow_vector.hpp), поэтому копия ShipStore делит с оригиналом все блоки,
+// которые ни одна из копий не меняла; запись — через mut().
+class ShipStore {
+public:
+  CowVector<int> actualArrival;
+  CowVector<int> unloadTime;
+  CowVector<int> startUnload;
+  CowVector<CargoType> type;
+  CowVector<ShipState> state;
+  // версия Port (Port::version) при последнем изменении судна
+  CowVector<std::uint64_t> version;
+
+  CowVector<ShipInfo> info;
+
+  int size() const { return (int)state.size(); }
+  bool empty() const { return state.empty(); }
+
+  void clear() {
+    actualArrival.clear();
+    unloadTime.clear();
+    startUnload.clear();
+    type.clear();
+    state.clear();
+    version.clear();
+    info.clear();
+  }
+
+  void reserve(std::size_t n) {
+    actualArrival.reserve(n);
+    unloadTime.reserve(n);
+    startUnload.reserve(n);
+    type.reserve(n);
+    state.reserve(n);
+    version.reserve(n);
+    info.reserve(n);
+  }
+
+  int add(ShipInfo shipInfo, CargoType cargo, int arrivalAt, int unload) {
+    actualArrival.push_back(arrivalAt);
+    unloadTime.push_back(unload);
+    startUnload.push_back(kNoTime);
+    type.push_back(cargo);
+    state.push_back(ShipState::EN_ROUTE);
+    version.push_back(0);
+    info.push_back(std::move(shipInfo));
+    return size() - 1;
+  }
+
+  int finish(int id) const {
+    return startUnload[id] == kNoTime ? kNoTime
+                                      : startUnload[id] + unloadTime[id];
+  }
+};
+
+// Очередь судов к кранам с интерфейсом std::queue. Номера лежат в CowVector
+// и не удаляются, pop только сдвигает голову: копия очереди делит блоки с
+// оригиналом, а память ограничена числом судов.
+class ShipQueue {
+public:
+  void push(int id) { items.push_back(id); }
+  void pop() { ++head; }
+  int front() const { return items[head]; }
+  bool empty() const { return head == items.size(); }
+  std::size_t size() const { return items.size() - head; }
+
+  void clear() {
+    items.clear();
+    head = 0;
+  }
+
+private:
+  CowVector<int> items;
+  std::size_t head = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Port;
+
+// Рассылка изменений состояния подписчикам GET /events (Server-Sent Events).
+//
+// Кто меняет Port, тот под блокировкой порта вызывает publish, и publish
+// только помечает подписчиков. Дельту Port::getState(since) строит поток
+// подписчика, когда готов писать, от версии, которую клиент уже получил.
+// Поэтому отставший клиент получает одно сообщение со всеми пропущенными
+// изменениями, а не очередь из них, и память на него не растёт. Дельта
+// от одной и той же версии строится один раз и отдаётся всем подписчикам,
+// которые на ней остановились. События жизненного цикла (reset, restore,
+// done…) копятся в короткой очереди, старые вытесняются.
+class StateStream {
+public:
+  static constexpr std::size_t kMaxEvents = 32;
+
+  struct Subscriber {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::string> events;
+    bool dirty = true;
+    bool closed = false;
+    // версия, до которой клиенту уже отдано состояние; меняется только
+    // потоком подписчика
+    std::uint64_t version = 0;
+  };
+
+  StateStream(const Port &port, std::mutex &portMutex)
+      : port(port), portMutex(portMutex) {}
+
+  // Новый подписчик; первым кадром получит изменения после since
+  // (0 — полное состояние).
+  std::shared_ptr<Subscriber> subscribe(std::uint64_t since);
+  void unsubscribe(const std::shared_ptr<Subscriber> &sub);
+
+  // Состояние порта изменилось; event — необязательное событие жизненного
+  // цикла с данными data (JSON). Вызывается под блокировкой порта.
+  void publish(const char *event = nullptr, const std::string &data = "{}");
+
+  // Ждёт изменений не дольше timeout и дописывает кадры в out в формате
+  // SSE (по таймауту — комментарий-пинг). false — подписка закрыта.
+  bool next(Subscriber &sub, std::string &out,
+            std::chrono::milliseconds timeout);
+
+  std::size_t size() const;
+  // закрывает все подписки (остановка сервера)
+  void close();
+
+private:
+  const Port &port;
+  std::mutex &portMutex;
+
+  mutable std::mutex mutex;
+  std::vector<std::shared_ptr<Subscriber>> subscribers;
+
+  // под portMutex: кадры состояния версии cacheVersion по since
+  std::map<std::uint64_t, std::shared_ptr<const std::string>> cache;
+  std::uint64_t cacheVersion = 0;
+  bool wasDone = false;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "replication.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Ось перебора: имя поля SimulationConfig (как в to_json) и его значения.
+struct SweepAxis {
+  std::string field;
+  std::vector<json> values;
+};
+
+// Сетка — декартово произведение осей. В JSON ось задаётся массивом
+// значений или диапазоном {"from", "to", "step"}:
+//   {"grid": {"cranesContainer": [1, 2, 3],
+//             "arrivalJitterMax": {"from": 0, "to": 2880, "step": 720}},
+//    "replications": 20}
+// Каждая точка прогоняется ровно replications раз; параметры
+// последовательной остановки (targetHalfWidth, targetRelative, kpi, batch,
+// maxReplications) отклоняются. Размер ограничен: не больше kMaxAxisValues значений на ось, kMaxPoints
+// точек и kMaxRuns прогонов (точки × репликации) — иначе invalid_argument.
+struct SweepSpec {
+  static constexpr int kMaxAxisValues = 10000;
+  static constexpr int kMaxPoints = 100000;
+  static constexpr long long kMaxRuns = 1000000;
+
+  std::vector<SweepAxis> axes;
+  ReplicationOptions replication;
+
+  int pointCount() const;
+  void validate(const SimulationConfig &base) const;
+  static SweepSpec from_json(const json &j);
+};
+
+struct SweepPoint {
+  int index = 0;
+  json params;
+  ReplicationResult result;
+
+  json to_json() const;
+};
+
+// Прогоняет все точки сетки × репликации на пуле потоков одним общим
+// набором задач. Расписание разбирается один раз и разделяется всеми
+// прогонами. onPoint вызывается (последовательно) по мере готовности точек,
+// порядок точек не гарантирован. Если cancel выставлен, оставшиеся прогоны
+// пропускаются.
+void runSweep(const SimulationConfig &base, const SweepSpec &spec,
+              const std::function<void(const SweepPoint &)> &onPoint,
+              const std::atomic<bool> *cancel = nullptr,
+              ThreadPool &pool = ThreadPool::shared());
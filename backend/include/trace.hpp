@@ -0,0 +1,47 @@
+#pragma once
+#include "config.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class Port;
+
+// Запись прогона в формате Chrome Trace Event (JSON), который открывают
+// chrome://tracing, Perfetto и speedscope. Каждый кран — отдельная дорожка
+// с интервалами разгрузки, очереди по типам груза — счётчики глубины,
+// прибытия — мгновенные события на дорожке «Прибытия». Время модели
+// отображается как есть: минута модели — минута на шкале.
+//
+// События пишутся по мере прогона из фаз Port и копятся в буфере не больше
+// chunkSize байт, после чего уходят в sink, так что длина трассы памяти не
+// занимает. Трасса заканчивается вызовом close (деструктор в sink не пишет).
+class TraceWriter {
+public:
+  using Sink = std::function<void(const std::string &chunk)>;
+
+  explicit TraceWriter(Sink sink, std::size_t chunkSize = 1 << 16);
+
+  // заголовок и имена дорожек; вызывается из Port::reset
+  void begin(const Port &port);
+  void arrive(int t, const std::string &ship, CargoType type);
+  void startUnload(int t, int crane, const std::string &ship);
+  void finishUnload(int t, int crane);
+  // глубина очередей; пишется только изменившаяся
+  void queues(int t, const int depth[3]);
+  void close();
+
+  std::uint64_t events() const { return count; }
+  // байт, ещё не отданных в sink
+  std::size_t pending() const { return buffer.size(); }
+
+private:
+  void event(const char *ph, int tid, int t);
+  void maybeFlush();
+
+  Sink sink;
+  std::size_t chunkSize;
+  std::string buffer;
+  std::uint64_t count = 0;
+  int lastDepth[3] = {-1, -1, -1};
+  bool open = false;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "config.hpp"
+#include "json.hpp"
+#include "port.hpp"
+#include "thread_pool.hpp"
+#include <limits>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Ветка «что если»: продолжение прогона из снимка с другой конфигурацией.
+struct WhatIfBranch {
+  std::string name;
+  SimulationConfig cfg;
+};
+
+struct WhatIfResult {
+  std::string name;
+  RunSummary summary;
+
+  json to_json() const;
+};
+
+// Каждая ветка получает свою копию origin, применяет Port::reconfigure и
+// прогоняется до until (или до конца) на пуле потоков. Копия Port делит с
+// оригиналом блоки судов и кранов, пока ветка их не изменит, так что
+// ответвление стоит копирования таблиц блоков, а не самих судов.
+std::vector<WhatIfResult>
+runWhatIf(const Port &origin, const std::vector<WhatIfBranch> &branches,
+          int until = std::numeric_limits<int>::max(),
+          ThreadPool &pool = ThreadPool::shared());
+
+// То же из двоичного снимка (Port::snapshot).
+std::vector<WhatIfResult>
+runWhatIf(const std::string &snapshot, const std::vector<WhatIfBranch> &branches,
+          int until = std::numeric_limits<int>::max(),
+          ThreadPool &pool = ThreadPool::shared());
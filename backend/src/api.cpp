@@ -1,20 +1,154 @@
 #include "api.hpp"
 #include "port.hpp"
+#include "replication.hpp"
+#include "sweep.hpp"
+#include "compare.hpp"
+#include "whatif.hpp"
+#include "journal.hpp"
+#include "log.hpp"
+#include "optimizer.hpp"
+#include "schedule_loader.hpp"
+#include "schedule_generator.hpp"
+#include "trace.hpp"
+#include "state_stream.hpp"
+#include "autorun.hpp"
 #include "json.hpp"
-#include <iostream>
+#include <charconv>
 #include <chrono>
-#include <iomanip>
+#include <limits>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 using json = nlohmann::json;
 
 
-namespace logcolor {
-    constexpr const char* reset  = "\033[0m";
-    constexpr const char* blue   = "\033[36m";
-    constexpr const char* green  = "\033[32m";
-    constexpr const char* yellow = "\033[33m";
-    constexpr const char* red    = "\033[31m";
-    constexpr const char* gray   = "\033[90m";
+// Строки NDJSON, которые фоновая задача отдаёт потоковому ответу.
+struct LineStream {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::string> lines;
+    bool done = false;
+    std::atomic<bool> cancel{false};
+
+    void push(std::string line) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(std::move(line));
+        }
+        cv.notify_all();
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        cv.notify_all();
+    }
+};
+
+void streamLines(httplib::Response& res, const std::shared_ptr<LineStream>& stream) {
+    res.set_chunked_content_provider(
+        "application/x-ndjson",
+        [stream](size_t, httplib::DataSink& sink) {
+            std::unique_lock<std::mutex> lock(stream->mutex);
+            stream->cv.wait(lock, [&] { return !stream->lines.empty() || stream->done; });
+            while (!stream->lines.empty()) {
+                std::string line = std::move(stream->lines.front()) + "\n";
+                stream->lines.pop_front();
+                lock.unlock();
+                if (!sink.write(line.data(), line.size())) {
+                    stream->cancel = true;
+                    return false;
+                }
+                lock.lock();
+            }
+            if (stream->done) {
+                sink.done();
+            }
+            return true;
+        },
+        [stream](bool success) {
+            if (!success) {
+                stream->cancel = true;
+            }
+        });
+}
+
+// Фоновая задача (оптимизация), состояние которой опрашивается через /jobs/:id.
+struct Job {
+    std::mutex mutex;
+    std::string status = "running";
+    json progress = json::array();
+    json result;
+    std::atomic<bool> cancel{false};
+    // когда задача завершилась; пока она идёт — нет
+    std::optional<std::chrono::steady_clock::time_point> finishedAt;
+
+    void finish(const std::string& final, json value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = std::move(value);
+        status = final;
+        finishedAt = std::chrono::steady_clock::now();
+    }
+
+    json to_json(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        json j{{"id", id}, {"status", status}, {"progress", progress}};
+        if (!result.is_null()) {
+            j["result"] = result;
+        }
+        return j;
+    }
+};
+
+static std::mutex jobsMutex;
+static std::map<int, std::shared_ptr<Job>> jobs;
+static int nextJobId = 1;
+
+// Завершённые задачи хранятся kJobTtl и не больше kMaxFinishedJobs
+// последних; после этого /jobs/:id отвечает 404.
+static constexpr std::chrono::minutes kJobTtl{60};
+static constexpr std::size_t kMaxFinishedJobs = 64;
+
+// под jobsMutex
+static void prune_jobs() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<int> finished;
+    for (auto it = jobs.begin(); it != jobs.end();) {
+        std::optional<std::chrono::steady_clock::time_point> at;
+        {
+            std::lock_guard<std::mutex> lock(it->second->mutex);
+            at = it->second->finishedAt;
+        }
+        if (at && now - *at > kJobTtl) {
+            it = jobs.erase(it);
+            continue;
+        }
+        if (at)
+            finished.push_back(it->first);
+        ++it;
+    }
+    // номера растут, так что первые — самые старые
+    for (std::size_t i = 0; i + kMaxFinishedJobs < finished.size(); ++i)
+        jobs.erase(finished[i]);
+}
+
+// Задача по номеру из пути; номер вне диапазона int — как несуществующий.
+static std::shared_ptr<Job> findJob(const httplib::Request& req, int& id) {
+    std::string text = req.matches[1];
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), id);
+    if (ec != std::errc() || end != text.data() + text.size())
+        return nullptr;
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    prune_jobs();
+    auto it = jobs.find(id);
+    return it == jobs.end() ? nullptr : it->second;
 }
 
 void add_cors(httplib::Response &res) {
@@ -23,29 +157,114 @@ void add_cors(httplib::Response &res) {
     res.set_header("Access-Control-Allow-Headers", "Content-Type");
 }
 
+// config, port и journal меняются обработчиками из разных потоков сервера
+// (а подписчики /events читают порт при публикации) — только под portMutex
+static std::mutex portMutex;
 static SimulationConfig config;
 static Port port;
+static EventJournal journal;
+static StateStream stateStream(port, portMutex);
+
+// Автопрогон идёт до конца расписания (или до застревания модели); смена
+// расписания, конфигурации или reset его останавливают.
+static AutoRunner autorun(
+    portMutex,
+    [](int steps) {
+        for (int i = 0; i < steps && !port.done(); ++i) {
+            port.simulateStep(config.step);
+        }
+        stateStream.publish();
+        return !port.done() && !port.stalled();
+    },
+    [] { stateStream.publish("pause", autorun.status().dump()); });
+
+// SSE-подписчик занимает поток сервера на всё время подписки, поэтому
+// потоков больше, чем допускается подписчиков
+static constexpr int kServerThreads = 64;
+static constexpr std::size_t kMaxSubscribers = 48;
+static constexpr std::chrono::seconds kHeartbeat{15};
 
 void init_port_from_config() {
+    port.journal = &journal;
     port.setConfig(&config);
     port.reset();
 }
 
+std::size_t load_schedule_file(const std::string& path, const std::string& format) {
+    auto schedule = loadSchedule(path, scheduleFormatFromName(format));
+    std::lock_guard<std::mutex> lock(portMutex);
+    autorun.pause();
+    config.schedule = std::move(schedule);
+    init_port_from_config();
+    stateStream.publish("reset");
+    return config.schedule.size();
+}
+
+static std::filesystem::path scheduleDir;
+
+void set_schedule_dir(const std::string& dir) {
+    scheduleDir = std::filesystem::canonical(dir);
+    if (!std::filesystem::is_directory(scheduleDir))
+        throw std::invalid_argument("not a directory: " + dir);
+}
+
+// Путь из POST /schedule — относительно scheduleDir; после раскрытия ссылок
+// и ".." файл должен остаться внутри каталога.
+static std::string resolve_schedule_path(const std::string& name) {
+    std::filesystem::path rel(name);
+    if (name.empty() || rel.is_absolute())
+        throw std::invalid_argument("schedule path must be relative to the data directory");
+    std::error_code ec;
+    auto path = std::filesystem::canonical(scheduleDir / rel, ec);
+    if (ec)
+        throw std::invalid_argument("cannot open schedule " + name);
+    auto inside = path.lexically_relative(scheduleDir);
+    if (inside.empty() || *inside.begin() == "..")
+        throw std::invalid_argument("schedule path must stay inside the data directory");
+    return path.string();
+}
+
+// Номер версии состояния из ?since= или Last-Event-ID: только цифры целиком.
+static std::uint64_t parse_version(const std::string& text) {
+    std::uint64_t v = 0;
+    auto end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, v);
+    if (text.empty() || ec != std::errc() || ptr != end) {
+        throw std::invalid_argument("invalid state version: " + text.substr(0, 32));
+    }
+    return v;
+}
+
+static std::optional<std::uint64_t> since_param(const httplib::Request& req) {
+    if (!req.has_param("since"))
+        return std::nullopt;
+    return parse_version(req.get_param_value("since"));
+}
+
+// Текущее состояние; с since — только изменения после этой версии
+// (полное состояние приходит с "full": true). Дельты отдаются без отступов.
+static std::string current_state(std::optional<std::uint64_t> since) {
+    if (!since)
+        return port.getState().dump(2);
+    return port.getState(*since).dump();
+}
+
+// Текущая конфигурация с полями из body["config"] поверх неё (под portMutex).
+static SimulationConfig configWithOverrides(const json& body) {
+    if (!body.contains("config")) {
+        return config;
+    }
+    json merged = config.to_json();
+    merged.merge_patch(body["config"]);
+    return SimulationConfig::from_json(merged);
+}
+
 void logRequest(const httplib::Request& req, int statusCode, double durationMs) {
-    using namespace logcolor;
-    std::string color = (statusCode >= 200 && statusCode < 300)
-                        ? green : (statusCode == 404 ? yellow : red);
-    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    std::tm* tm = std::localtime(&now);
-    std::ostringstream timestamp;
-    timestamp << std::put_time(tm, "%H:%M:%S");
-
-    std::cout << gray << "[" << timestamp.str() << "] " << reset
-              << blue << req.method << " " << reset
-              << req.path << " "
-              << color << statusCode << reset
-              << " (" << std::fixed << std::setprecision(1) << durationMs << " ms)"
-              << std::endl;
+    if (statusCode >= 400) {
+        SEAPORT_LOG(WARN, LogRecord::request(req.method, req.path, statusCode, durationMs));
+    } else {
+        SEAPORT_LOG(INFO, LogRecord::request(req.method, req.path, statusCode, durationMs));
+    }
 }
 
 template<typename Handler>
@@ -61,6 +280,8 @@ auto withLogging(Handler handler) {
 }
 
 void setup_routes(httplib::Server& app) {
+    app.new_task_queue = [] { return new httplib::ThreadPool(kServerThreads); };
+
     app.Options(R"(.*)", withLogging([](const httplib::Request&, httplib::Response& res) {
         add_cors(res);
         res.status = 200;
@@ -68,6 +289,7 @@ void setup_routes(httplib::Server& app) {
 
     app.Get("/config", withLogging([](const httplib::Request&, httplib::Response& res) {
         add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
         res.set_content(config.to_json().dump(2), "application/json");
         res.status = 200;
     }));
@@ -76,8 +298,12 @@ void setup_routes(httplib::Server& app) {
         add_cors(res);
         try {
             auto body = json::parse(req.body);
-            config = SimulationConfig::from_json(body);
+            auto parsed = SimulationConfig::from_json(body);
+            std::lock_guard<std::mutex> lock(portMutex);
+            autorun.pause();
+            config = std::move(parsed);
             init_port_from_config();
+            stateStream.publish("config");
             res.set_content(config.to_json().dump(2), "application/json");
             res.status = 200;
         } catch (std::exception& e) {
@@ -86,30 +312,506 @@ void setup_routes(httplib::Server& app) {
         }
     }));
 
-    app.Get("/state", withLogging([](const httplib::Request&, httplib::Response& res) {
+    // Расписание из файла в каталоге --data-dir: {"path": "ships.csv", "format": "csv"}
+    app.Post("/schedule", withLogging([](const httplib::Request& req, httplib::Response& res) {
         add_cors(res);
-        res.set_content(port.getState().dump(2), "application/json");
+        if (scheduleDir.empty()) {
+            res.status = 403;
+            res.set_content(json{{"error", "schedule files are disabled; start the server with --data-dir"}}.dump(),
+                            "application/json");
+            return;
+        }
+        try {
+            auto body = json::parse(req.body);
+            auto name = body.at("path").get<std::string>();
+            auto path = resolve_schedule_path(name);
+            std::size_t ships;
+            try {
+                ships = load_schedule_file(path, body.value("format", "auto"));
+            } catch (std::exception& e) {
+                // в ответ — путь, как его назвал клиент, а не путь на сервере
+                throw std::runtime_error(name + ": " + e.what());
+            }
+            res.set_content(json{{"ships", ships}}.dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    // Синтетическое расписание вместо текущего:
+    // {"seed": 7, "horizon": 43200, "streams": [{"type": "CONTAINER", "arrivals": {...}, "weight": {...}}]}
+    app.Post("/generate", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            auto spec = ScheduleSpec::from_json(json::parse(req.body));
+            auto schedule = generateSchedule(spec);
+            std::lock_guard<std::mutex> lock(portMutex);
+            autorun.pause();
+            config.schedule = std::move(schedule);
+            init_port_from_config();
+            stateStream.publish("reset");
+            res.set_content(json{{"ships", config.schedule.size()}}.dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    // ?t= — состояние на прошедший момент по опорным кадрам журнала,
+    // ?since= — изменения после версии (см. current_state)
+    app.Get("/state", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        try {
+            if (!req.has_param("t")) {
+                res.set_content(current_state(since_param(req)), "application/json");
+                res.status = 200;
+                return;
+            }
+            int t = std::min(std::stoi(req.get_param_value("t")), port.now);
+            Port past;
+            journal.stateAt(t, past);
+            res.set_content(past.getState().dump(2), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    // Изменения состояния потоком Server-Sent Events: первым кадром полное
+    // состояние (или изменения после Last-Event-ID / ?since=), дальше дельты
+    // после каждого изменения порта и события reset, config, restore, done.
+    // Отставшему клиенту дельты сливаются в одну (см. StateStream).
+    app.Get("/events", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        std::uint64_t since = 0;
+        try {
+            if (req.has_header("Last-Event-ID")) {
+                since = parse_version(req.get_header_value("Last-Event-ID"));
+            } else {
+                since = since_param(req).value_or(0);
+            }
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+        if (stateStream.size() >= kMaxSubscribers) {
+            res.status = 503;
+            res.set_content(json{{"error", "Too many subscribers"}}.dump(), "application/json");
+            return;
+        }
+
+        auto sub = stateStream.subscribe(since);
+        res.set_header("Cache-Control", "no-cache");
+        res.set_chunked_content_provider(
+            "text/event-stream",
+            [sub](size_t, httplib::DataSink& sink) {
+                std::string out;
+                if (!stateStream.next(*sub, out, kHeartbeat)) {
+                    sink.done();
+                    return true;
+                }
+                return sink.write(out.data(), out.size());
+            },
+            [sub](bool) { stateStream.unsubscribe(sub); });
         res.status = 200;
     }));
 
-    app.Post("/step", withLogging([](const httplib::Request&, httplib::Response& res) {
+    app.Post("/step", withLogging([](const httplib::Request& req, httplib::Response& res) {
     add_cors(res);
+    // since проверяется до шага: при ошибке в запросе шаг не делается
+    std::optional<std::uint64_t> since;
+    try {
+        since = since_param(req);
+    } catch (std::exception& e) {
+        res.status = 400;
+        res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(portMutex);
 
     port.simulateStep(config.step);
+    stateStream.publish();
 
-    res.set_content(port.getState().dump(2), "application/json");
+    res.set_content(current_state(since), "application/json");
     res.status = 200;
 }));
 
+    // Автопрогон на сервере: {"speed": минут модели в секунду, "stepsPerTick": 1}.
+    // Повторный вызов меняет скорость; клиенты следят за прогоном через /events.
+    app.Post("/autorun", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            auto settings = AutoRunner::Settings::from_json(body);
+            std::lock_guard<std::mutex> lock(portMutex);
+            autorun.start(settings, config.step);
+            json status = autorun.status();
+            stateStream.publish("autorun", status.dump());
+            res.set_content(status.dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    app.Get("/autorun", withLogging([](const httplib::Request&, httplib::Response& res) {
+        add_cors(res);
+        res.set_content(autorun.status().dump(), "application/json");
+        res.status = 200;
+    }));
+
+    // после ответа шагов автопрогона больше не будет
+    app.Post("/pause", withLogging([](const httplib::Request&, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        autorun.pause();
+        json status = autorun.status();
+        stateStream.publish("pause", status.dump());
+        res.set_content(status.dump(), "application/json");
+        res.status = 200;
+    }));
+
+    app.Post("/run", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            int until = body.value("until", std::numeric_limits<int>::max());
+            long long maxEvents = body.value("maxEvents", std::numeric_limits<long long>::max());
+
+            port.logEvents = body.value("log", false);
+            long long processed = port.run(until, maxEvents);
+            port.logEvents = true;
+            stateStream.publish();
+
+            RunSummary summary = port.summarize();
+            summary.events = processed;
+            res.set_content(summary.to_json().dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            port.logEvents = true;
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    app.Post("/replicate", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            SimulationConfig cfg;
+            {
+                std::lock_guard<std::mutex> lock(portMutex);
+                cfg = configWithOverrides(body);
+            }
+            auto opt = ReplicationOptions::from_json(body);
+
+            res.set_content(replicate(cfg, opt).to_json().dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    app.Post("/compare", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            SimulationConfig a, b;
+            {
+                std::lock_guard<std::mutex> lock(portMutex);
+                a = configWithOverrides(json{{"config", body.value("a", json::object())}});
+                b = configWithOverrides(json{{"config", body.value("b", json::object())}});
+            }
+            auto opt = CompareOptions::from_json(body);
+
+            res.set_content(compareConfigs(a, b, opt).to_json().dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    app.Post("/sweep", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        SimulationConfig base;
+        SweepSpec spec;
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            {
+                std::lock_guard<std::mutex> lock(portMutex);
+                base = configWithOverrides(body);
+            }
+            spec = SweepSpec::from_json(body);
+            spec.validate(base);
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+
+        auto stream = std::make_shared<LineStream>();
+        stream->push(json{{"points", spec.pointCount()},
+                          {"replications", spec.replication.replications}}.dump());
+
+        std::thread([stream, base = std::move(base), spec = std::move(spec)] {
+            try {
+                runSweep(base, spec, [&](const SweepPoint& point) {
+                    stream->push(point.to_json().dump());
+                }, &stream->cancel);
+                stream->push(json{{"done", true}}.dump());
+            } catch (std::exception& e) {
+                stream->push(json{{"error", e.what()}}.dump());
+            }
+            stream->finish();
+        }).detach();
+
+        streamLines(res, stream);
+        res.status = 200;
+    }));
+
+    app.Post("/optimize", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        SimulationConfig base;
+        OptimizeSpec spec;
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            {
+                std::lock_guard<std::mutex> lock(portMutex);
+                base = configWithOverrides(body);
+            }
+            spec = OptimizeSpec::from_json(body);
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+
+        auto job = std::make_shared<Job>();
+        int id;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            prune_jobs();
+            id = nextJobId++;
+            jobs[id] = job;
+        }
+
+        std::thread([job, base = std::move(base), spec = std::move(spec)] {
+            try {
+                auto result = optimizeCranes(base, spec, [&](const CandidateResult& c) {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->progress.push_back(c.to_json());
+                }, &job->cancel);
+                job->finish(job->cancel ? "cancelled" : "done", result.to_json());
+            } catch (std::exception& e) {
+                job->finish("failed", json{{"error", e.what()}});
+            }
+        }).detach();
+
+        res.set_content(json{{"job", id}}.dump(), "application/json");
+        res.status = 202;
+    }));
+
+    app.Get(R"(/jobs/(\d+))", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        int id = 0;
+        auto job = findJob(req, id);
+        if (!job) {
+            res.status = 404;
+            res.set_content(json{{"error", "Job not found"}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(job->to_json(id).dump(), "application/json");
+        res.status = 200;
+    }));
+
+    app.Post(R"(/jobs/(\d+)/cancel)", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        int id = 0;
+        auto job = findJob(req, id);
+        if (!job) {
+            res.status = 404;
+            res.set_content(json{{"error", "Job not found"}}.dump(), "application/json");
+            return;
+        }
+        job->cancel = true;
+        res.set_content(job->to_json(id).dump(), "application/json");
+        res.status = 200;
+    }));
+
+    app.Get("/snapshot", withLogging([](const httplib::Request&, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        res.set_content(port.snapshot(), "application/octet-stream");
+        res.status = 200;
+    }));
+
+    app.Post("/restore", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        try {
+            port.restore(req.body);
+            autorun.pause();
+            stateStream.publish("restore");
+            res.set_content(port.getState().dump(2), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    // Ветки «что если» от текущего момента:
+    // {"until": ..., "branches": [{"name": "+1 кран", "config": {"cranesContainer": 2}}]}
+    app.Post("/fork", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            auto body = req.body.empty() ? json::object() : json::parse(req.body);
+            int until = body.value("until", std::numeric_limits<int>::max());
+
+            // ветки считаются от копии: она делит блоки с портом, а прогон
+            // веток не держит portMutex
+            std::vector<WhatIfBranch> branches;
+            Port origin;
+            {
+                std::lock_guard<std::mutex> lock(portMutex);
+                for (auto const& b : body.value("branches", json::array())) {
+                    WhatIfBranch branch;
+                    branch.name = b.value("name", "branch " + std::to_string(branches.size()));
+                    branch.cfg = configWithOverrides(b);
+                    branches.push_back(std::move(branch));
+                }
+                origin = port;
+            }
+
+            json out = json::array();
+            for (auto const& r : runWhatIf(origin, branches, until)) {
+                out.push_back(r.to_json());
+            }
+            res.set_content(json{{"now", origin.now}, {"branches", out}}.dump(), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
+    // Трасса для chrome://tracing / Perfetto: текущая конфигурация
+    // прогоняется заново на отдельном Port до ?until= (по умолчанию — до
+    // текущего момента, а если прогон ещё не начат — до конца), трасса
+    // отдаётся кусками по мере прогона.
+    app.Get("/trace", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        struct TraceRun {
+            SimulationConfig cfg;
+            Port port;
+            std::string chunk;
+            std::unique_ptr<TraceWriter> writer;
+            int until = 0;
+            bool finished = false;
+        };
+        auto run = std::make_shared<TraceRun>();
+        std::unique_lock<std::mutex> lock(portMutex);
+        try {
+            run->until = req.has_param("until") ? std::stoi(req.get_param_value("until"))
+                         : port.now > 0         ? port.now
+                                                : std::numeric_limits<int>::max();
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+        run->cfg = config;
+        lock.unlock();
+        run->writer = std::make_unique<TraceWriter>([raw = run.get()](const std::string& chunk) {
+            raw->chunk += chunk;
+        });
+        run->port.logEvents = false;
+        run->port.trace = run->writer.get();
+        run->port.setConfig(&run->cfg);
+        run->port.reset();
+
+        res.set_header("Content-Disposition", "attachment; filename=\"seaport-trace.json\"");
+        res.set_chunked_content_provider(
+            "application/json",
+            [run](size_t, httplib::DataSink& sink) {
+                constexpr long long kEventsPerPass = 256;
+                while (run->chunk.empty() && !run->finished) {
+                    if (run->port.run(run->until, kEventsPerPass) < kEventsPerPass) {
+                        run->writer->close();
+                        run->finished = true;
+                    }
+                }
+                if (!run->chunk.empty()) {
+                    if (!sink.write(run->chunk.data(), run->chunk.size())) {
+                        return false;
+                    }
+                    run->chunk.clear();
+                }
+                if (run->finished) {
+                    sink.done();
+                }
+                return true;
+            });
+    }));
+
+    app.Get("/journal", withLogging([](const httplib::Request&, httplib::Response& res) {
+        add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        res.set_content(journal.data(), "application/octet-stream");
+        res.status = 200;
+    }));
+
+    // Состояние после первых events записей журнала текущего прогона.
+    app.Get("/journal/state", withLogging([](const httplib::Request& req, httplib::Response& res) {
+        add_cors(res);
+        try {
+            std::size_t events = req.has_param("events")
+                ? std::stoull(req.get_param_value("events"))
+                : std::numeric_limits<std::size_t>::max();
+            std::unique_lock<std::mutex> lock(portMutex);
+            JournalReplayer replayer(journal.data());
+            lock.unlock();
+            Port replayed;
+            replayed.logEvents = false;
+            std::size_t applied = replayer.replay(replayed, events);
+
+            json state = replayed.getState();
+            state["events"] = applied;
+            state["totalEvents"] = replayer.eventCount();
+            res.set_content(state.dump(2), "application/json");
+            res.status = 200;
+        } catch (std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    }));
+
     app.Post("/reset", withLogging([](const httplib::Request&, httplib::Response& res) {
         add_cors(res);
+        std::lock_guard<std::mutex> lock(portMutex);
+        autorun.pause();
         port.reset();
+        stateStream.publish("reset");
         res.set_content(port.getState().dump(2), "application/json");
         res.status = 200;
     }));
 
     app.set_error_handler(withLogging([](const httplib::Request& r, httplib::Response& res) {
         add_cors(res);
+        // обработчик маршрута уже описал ошибку (например, 400 с текстом)
+        if (!res.body.empty()) {
+            return;
+        }
         res.status = 404;
         res.set_content(json{{"error","Route not found"},{"path", r.path}}.dump(2), "application/json");
     }));
@@ -0,0 +1,149 @@
+#include "autorun.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// тиков не чаще 100 в секунду: на больших скоростях за тик делается больше
+// шагов, иначе поток почти не отпускал бы блокировку порта
+static constexpr double kMinTickSeconds = 0.01;
+// шагов за тик, включая добавленные ограничением частоты: столько тик
+// держит блокировку порта
+static constexpr int kMaxStepsPerTick = 1000;
+// пауза после тика, когда прогон не успевает за скоростью, — чтобы
+// обработчики запросов и подписчики успели взять блокировку порта
+static constexpr std::chrono::milliseconds kBreather{1};
+
+AutoRunner::Settings AutoRunner::Settings::from_json(const json &j) {
+  Settings s;
+  if (j.contains("speed")) s.speed = j["speed"];
+  if (j.contains("stepsPerTick")) s.stepsPerTick = j["stepsPerTick"];
+  if (!(s.speed > 0))
+    throw std::invalid_argument("speed must be positive");
+  // при шаге в минуту такая скорость даёт kMaxStepsPerTick шагов за тик
+  if (s.speed > kMaxStepsPerTick / kMinTickSeconds)
+    throw std::invalid_argument(
+        "speed must not exceed " +
+        std::to_string((long long)(kMaxStepsPerTick / kMinTickSeconds)));
+  if (s.stepsPerTick < 1)
+    throw std::invalid_argument("stepsPerTick must be at least 1");
+  if (s.stepsPerTick > kMaxStepsPerTick)
+    throw std::invalid_argument("stepsPerTick must not exceed " +
+                                std::to_string(kMaxStepsPerTick));
+  return s;
+}
+
+AutoRunner::AutoRunner(std::mutex &portMutex, Step step,
+                       std::function<void()> stopped)
+    : portMutex(portMutex), step(std::move(step)),
+      stopped(std::move(stopped)) {}
+
+AutoRunner::~AutoRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  cv.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void AutoRunner::start(const Settings &s, int stepMinutes) {
+  if (stepMinutes <= 0)
+    throw std::invalid_argument("step must be positive");
+  double seconds = (double)s.stepsPerTick * stepMinutes / s.speed;
+  double steps = s.stepsPerTick;
+  if (seconds < kMinTickSeconds) {
+    double k = std::ceil(kMinTickSeconds / seconds - 1e-9);
+    steps *= k;
+    seconds *= k;
+  }
+  if (steps > kMaxStepsPerTick)
+    throw std::invalid_argument("speed too high: more than " +
+                                std::to_string(kMaxStepsPerTick) +
+                                " steps per tick");
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = s;
+    batch = (int)steps;
+    interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+    running = true;
+    ++generation;
+    if (!worker.joinable())
+      worker = std::thread([this] { run(); });
+  }
+  cv.notify_all();
+}
+
+void AutoRunner::pause() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+      running = false;
+      ++generation;
+    }
+  }
+  cv.notify_all();
+}
+
+json AutoRunner::status() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return {{"running", running},
+          {"speed", settings.speed},
+          {"stepsPerTick", settings.stepsPerTick},
+          {"ticks", ticks}};
+}
+
+void AutoRunner::run() {
+  using clock = std::chrono::steady_clock;
+  std::unique_lock<std::mutex> lock(mutex);
+  unsigned gen = generation;
+  auto next = clock::now();
+
+  for (;;) {
+    cv.wait(lock, [&] { return quit || running; });
+    if (quit)
+      return;
+    if (gen != generation) {
+      // новый запуск или новая скорость: первый тик сразу
+      gen = generation;
+      next = clock::now();
+    }
+    if (cv.wait_until(lock, next,
+                      [&] { return quit || gen != generation; }))
+      continue;
+
+    int steps = batch;
+    next += interval;
+    // модель не успевает за скоростью — отставание не копим, иначе после
+    // тяжёлого участка шаги пошли бы без пауз
+    if (clock::now() - next > std::chrono::seconds(1))
+      next = clock::now();
+    lock.unlock();
+
+    bool finished = false;
+    {
+      std::lock_guard<std::mutex> portLock(portMutex);
+      lock.lock();
+      bool current = running && gen == generation;
+      if (current)
+        ++ticks;
+      lock.unlock();
+
+      if (current && !step(steps)) {
+        lock.lock();
+        if (gen == generation) {
+          running = false;
+          ++generation;
+          finished = true;
+        }
+        lock.unlock();
+        if (finished)
+          stopped();
+      }
+    }
+    next = std::max(next, clock::now() + kBreather);
+    lock.lock();
+  }
+}
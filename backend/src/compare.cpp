@@ -0,0 +1,115 @@
+#include "compare.hpp"
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+CompareOptions CompareOptions::from_json(const json &j) {
+  CompareOptions o;
+  // пар ровно replications: последовательной остановки по разности нет
+  for (const char *key :
+       {"targetHalfWidth", "targetRelative", "kpi", "batch", "maxReplications"}) {
+    if (j.contains(key))
+      throw std::invalid_argument(std::string("compare does not support '") +
+                                  key + "'; use a fixed replications count");
+  }
+  o.replication = ReplicationOptions::from_json(j);
+  if (j.contains("antithetic")) o.antithetic = j["antithetic"];
+  return o;
+}
+
+json KpiComparison::to_json() const {
+  return {{"a", a.to_json()},
+          {"b", b.to_json()},
+          {"diff", diff.to_json()},
+          {"independentHalfWidth", independentHalfWidth},
+          {"significant", significant()}};
+}
+
+json CompareResult::to_json() const {
+  return {{"pairs", pairs},
+          {"runs", runs},
+          {"confidence", confidence},
+          {"antithetic", antithetic},
+          {"fine", fine.to_json()},
+          {"meanWait", meanWait.to_json()},
+          {"utilization", utilization.to_json()},
+          {"makespan", makespan.to_json()}};
+}
+
+CompareResult compareConfigs(const SimulationConfig &a,
+                             const SimulationConfig &b,
+                             const CompareOptions &opt, ThreadPool &pool) {
+  int pairs = std::max(0, opt.replication.replications);
+  int legs = opt.antithetic ? 2 : 1;
+  const SimulationConfig *cfgs[2] = {&a, &b};
+  const std::vector<SimulationConfig::ShipPlan> *schedules[2] = {
+      &a.schedule, b.schedule.empty() ? &a.schedule : &b.schedule};
+
+  // pending[(c * pairs + i) * legs + leg]
+  std::vector<std::future<RunSummary>> pending;
+  pending.reserve((std::size_t)2 * pairs * legs);
+  for (int c = 0; c < 2; ++c) {
+    for (int i = 0; i < pairs; ++i) {
+      unsigned seed = replicationSeed(a.seed, i);
+      for (int leg = 0; leg < legs; ++leg) {
+        pending.push_back(pool.submit([&, c, seed, leg] {
+          return runReplication(*cfgs[c], seed, opt.replication.until,
+                                schedules[c], leg == 1);
+        }));
+      }
+    }
+  }
+
+  std::vector<RunSummary> runs;
+  runs.reserve(pending.size());
+  std::exception_ptr error;
+  for (auto &f : pending) {
+    try {
+      runs.push_back(f.get());
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+
+  double conf = opt.replication.confidence;
+  auto compare = [&](Kpi kpi) {
+    std::vector<double> xa(pairs), xb(pairs), d(pairs);
+    for (int i = 0; i < pairs; ++i) {
+      double va = 0.0, vb = 0.0;
+      for (int leg = 0; leg < legs; ++leg) {
+        va += kpiValue(runs[(0 * pairs + i) * legs + leg], kpi);
+        vb += kpiValue(runs[(1 * pairs + i) * legs + leg], kpi);
+      }
+      xa[i] = va / legs;
+      xb[i] = vb / legs;
+      d[i] = xb[i] - xa[i];
+    }
+
+    KpiComparison k;
+    k.a = computeStats(std::move(xa), conf);
+    k.b = computeStats(std::move(xb), conf);
+    k.diff = computeStats(std::move(d), conf);
+    if (pairs > 1) {
+      double t = studentQuantile(0.5 + conf / 2.0, pairs - 1);
+      k.independentHalfWidth =
+          t * std::sqrt((k.a.stddev * k.a.stddev + k.b.stddev * k.b.stddev) /
+                        pairs);
+    }
+    return k;
+  };
+
+  CompareResult res;
+  res.pairs = pairs;
+  res.runs = (long long)runs.size();
+  res.confidence = conf;
+  res.antithetic = opt.antithetic;
+  res.fine = compare(Kpi::FINE);
+  res.meanWait = compare(Kpi::MEAN_WAIT);
+  res.utilization = compare(Kpi::UTILIZATION);
+  res.makespan = compare(Kpi::MAKESPAN);
+  return res;
+}
@@ -0,0 +1,268 @@
+#include "journal.hpp"
+#include "port.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static constexpr std::uint32_t kJournalMagic = 0x4c4a5053; // "SPJL"
+static constexpr std::uint8_t kJournalVersion = 1;
+
+void EventJournal::begin(const Port &port) {
+  out.buffer.clear();
+  last = port.now;
+  count = 0;
+  every = keyframeEvery;
+  closed = false;
+  closedAt = 0;
+
+  json cfg = port.cfg->to_json(false);
+  out.put(kJournalMagic);
+  out.put(kJournalVersion);
+  out.putString(cfg.dump());
+  out.putString(port.snapshot());
+
+  frames.clear();
+  capture(port);
+}
+
+void EventJournal::capture(const Port &port) {
+  if (frames.size() >= maxKeyframes && frames.size() > 1) {
+    // прореживание: кадры 0, 2, 4… — интервал между оставшимися удвоен
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < frames.size(); i += 2)
+      frames[kept++] = std::move(frames[i]);
+    frames.resize(kept);
+    every *= 2;
+  }
+  auto copy = std::make_shared<Port>(port);
+  copy->journal = nullptr;
+  copy->trace = nullptr;
+  copy->logEvents = false;
+  frames.push_back({port.now, count, out.buffer.size(), last, std::move(copy)});
+}
+
+void EventJournal::checkpoint(const Port &port) {
+  if (closed)
+    return;
+  if (out.buffer.size() >= maxBytes) {
+    // закрываем на границе шага, чтобы журнал кончался целым шагом
+    closed = true;
+    closedAt = port.now;
+    return;
+  }
+  if (!frames.empty() && count - frames.back().event >= every)
+    capture(port);
+}
+
+void EventJournal::stamp(JournalEvent e, int t) {
+  out.put(e);
+  out.putVarint(std::uint32_t(t - last));
+  last = t;
+  ++count;
+}
+
+void EventJournal::arrive(int t, int ship) {
+  if (closed)
+    return;
+  stamp(JournalEvent::ARRIVE, t);
+  out.putVarint(ship);
+}
+
+void EventJournal::assign(int t, int ship, int crane) {
+  if (closed)
+    return;
+  stamp(JournalEvent::ASSIGN, t);
+  out.putVarint(ship);
+  out.putVarint(crane);
+}
+
+void EventJournal::finish(int t, int ship, int crane) {
+  if (closed)
+    return;
+  stamp(JournalEvent::FINISH, t);
+  out.putVarint(ship);
+  out.putVarint(crane);
+}
+
+void EventJournal::fine(int t, int minutes) {
+  if (closed)
+    return;
+  stamp(JournalEvent::FINE, t);
+  out.putVarint(std::uint32_t(minutes));
+}
+
+namespace {
+// Одна запись журнала в разобранном виде.
+struct Record {
+  JournalEvent type;
+  int time;
+  int ship = 0;
+  int crane = 0;
+  int minutes = 0;
+};
+
+Record readRecord(BinaryReader &r, int &clock) {
+  Record rec;
+  rec.type = r.get<JournalEvent>();
+  clock += (int)r.getVarint();
+  rec.time = clock;
+  switch (rec.type) {
+  case JournalEvent::ARRIVE:
+    rec.ship = (int)r.getVarint();
+    break;
+  case JournalEvent::ASSIGN:
+  case JournalEvent::FINISH:
+    rec.ship = (int)r.getVarint();
+    rec.crane = (int)r.getVarint();
+    break;
+  case JournalEvent::FINE:
+    rec.minutes = (int)r.getVarint();
+    break;
+  default:
+    throw std::runtime_error("journal: unknown record type");
+  }
+  return rec;
+}
+
+void apply(Port &port, const Record &rec) {
+  switch (rec.type) {
+  case JournalEvent::ARRIVE:
+    port.applyArrival(rec.time, rec.ship);
+    break;
+  case JournalEvent::ASSIGN:
+    port.applyAssign(rec.time, rec.ship, rec.crane);
+    break;
+  case JournalEvent::FINISH:
+    port.applyFinish(rec.time, rec.ship, rec.crane);
+    break;
+  case JournalEvent::FINE:
+    port.applyFine(rec.time, rec.minutes);
+    break;
+  }
+}
+} // namespace
+
+void EventJournal::stateAt(int t, Port &state) const {
+  if (frames.empty())
+    throw std::logic_error("journal is empty");
+  if (closed && t > closedAt)
+    throw std::out_of_range("journal is full since t=" +
+                            std::to_string(closedAt) +
+                            ", later states are not kept");
+
+  // последний кадр не позже t (первый — состояние после reset)
+  auto it = std::upper_bound(
+      frames.begin(), frames.end(), t,
+      [](int time, const Keyframe &f) { return time < f.time; });
+  const Keyframe &frame = it == frames.begin() ? frames.front() : *(it - 1);
+
+  state = *frame.port;
+  BinaryReader r(out.buffer.data() + frame.offset,
+                 out.buffer.size() - frame.offset);
+  int clock = frame.lastRecord;
+  while (!r.atEnd()) {
+    Record rec = readRecord(r, clock);
+    if (rec.time > t)
+      break;
+    apply(state, rec);
+  }
+  state.now = std::max(state.now, t);
+}
+
+JournalReplayer::JournalReplayer(std::string journal) : data(std::move(journal)) {
+  BinaryReader r(data);
+  if (r.get<std::uint32_t>() != kJournalMagic)
+    throw std::runtime_error("journal: bad signature");
+  if (r.get<std::uint8_t>() != kJournalVersion)
+    throw std::runtime_error("journal: unsupported version");
+  cfg = SimulationConfig::from_json(json::parse(r.getString()));
+  initial = r.getString();
+  bodyOffset = r.position();
+
+  // проверяем целостность и считаем записи один раз
+  int clock = 0;
+  while (!r.atEnd()) {
+    readRecord(r, clock);
+    ++count;
+  }
+}
+
+std::size_t JournalReplayer::replay(Port &port, std::size_t events) const {
+  port.journal = nullptr;
+  port.setConfig(&cfg);
+  port.restore(initial);
+
+  BinaryReader r(data.data() + bodyOffset, data.size() - bodyOffset);
+  int clock = port.now;
+  std::size_t applied = 0;
+  while (applied < events && !r.atEnd()) {
+    apply(port, readRecord(r, clock));
+    ++applied;
+  }
+  return applied;
+}
+
+// --- применение записей к Port ---
+
+static void checkShip(const Port &port, int ship) {
+  if (ship < 0 || ship >= port.ships.size())
+    throw std::runtime_error("journal: ship id out of range");
+}
+
+void Port::applyArrival(int t, int ship) {
+  checkShip(*this, ship);
+  now = t;
+  CargoType type = ships.type[ship];
+  ships.state.mut(ship) = ShipState::QUEUED;
+  touchShip(ship);
+  queueFor(type).push(ship);
+  waiting[(int)type]++;
+  ++arrivalCursor;
+}
+
+void Port::applyAssign(int t, int ship, int crane) {
+  checkShip(*this, ship);
+  int type = (int)ships.type[ship];
+  auto &pool = freeCranes[type];
+  auto &q = queueFor((CargoType)type);
+  if (q.empty() || q.front() != ship || pool.empty() ||
+      pool.top().second != crane)
+    throw std::runtime_error("journal: assignment does not match state");
+  now = t;
+  pool.pop();
+  q.pop();
+
+  waiting[type]--;
+  ships.state.mut(ship) = ShipState::UNLOADING;
+  ships.startUnload.mut(ship) = t;
+  touchShip(ship);
+  int finish = ships.finish(ship);
+
+  auto &c = cranes.mut(crane);
+  c.busy = true;
+  c.busyUntil = finish;
+  c.busyMinutes += ships.unloadTime[ship];
+  c.version = version;
+
+  ++startedCount;
+  completions.push({finish, ship, crane});
+}
+
+void Port::applyFinish(int t, int ship, int crane) {
+  if (completions.empty() || completions.top().ship != ship ||
+      completions.top().crane != crane)
+    throw std::runtime_error("journal: completion does not match state");
+  now = t;
+  completions.pop();
+  releaseCrane(crane);
+  ships.state.mut(ship) = ShipState::FINISHED;
+  touchShip(ship);
+  ++finishedCount;
+}
+
+// штраф пересчитывается по тем же счётчикам ожидающих судов, что и при
+// прогоне, поэтому суммы совпадают до бита
+void Port::applyFine(int t, int minutes) {
+  now = t;
+  accrueFine(minutes);
+}
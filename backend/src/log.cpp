@@ -0,0 +1,353 @@
+#include "log.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace termcolor {
+constexpr const char *reset = "\033[0m";
+constexpr const char *gray = "\033[90m";
+constexpr const char *cyan = "\033[36m";
+constexpr const char *yellow = "\033[33m";
+constexpr const char *green = "\033[32m";
+constexpr const char *blue = "\033[34m";
+constexpr const char *red = "\033[31m";
+} // namespace termcolor
+
+static const char *levelNames[] = {"TRACE", "DEBUG", "INFO",
+                                   "WARN",  "ERROR", "OFF"};
+static const char *cargoNames[] = {"BULK", "LIQUID", "CONTAINER"};
+static const char *cargoIcons[] = {"⛏", "🛢", "📦"};
+
+LogLevel logLevelFromName(const std::string &name) {
+  std::string s = name;
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](unsigned char ch) { return std::toupper(ch); });
+  if (s == "ERR")
+    return LogLevel::ERR;
+  for (int l = 0; l <= (int)LogLevel::OFF; ++l) {
+    if (s == levelNames[l])
+      return (LogLevel)l;
+  }
+  throw std::invalid_argument("unknown log level: " + name);
+}
+
+const char *logLevelName(LogLevel level) { return levelNames[(int)level]; }
+
+// --- LogRecord ---
+
+// Копия с обрезкой по границе символа UTF-8.
+template <std::size_t N> static void copyText(char (&dst)[N], std::string_view s) {
+  std::size_t n = std::min(s.size(), N - 1);
+  if (n < s.size()) {
+    while (n > 0 && (static_cast<unsigned char>(s[n]) & 0xC0) == 0x80)
+      --n;
+  }
+  std::copy(s.data(), s.data() + n, dst);
+  dst[n] = '\0';
+}
+
+static LogRecord stamped(LogEvent e) {
+  LogRecord rec;
+  rec.event = e;
+  rec.wall = std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+                 .count();
+  return rec;
+}
+
+LogRecord LogRecord::message(std::string_view text) {
+  LogRecord rec = stamped(LogEvent::MESSAGE);
+  copyText(rec.text, text);
+  return rec;
+}
+
+LogRecord LogRecord::arrival(int t, std::string_view ship, CargoType type) {
+  LogRecord rec = stamped(LogEvent::ARRIVE);
+  rec.time = t;
+  rec.cargo = type;
+  copyText(rec.name, ship);
+  return rec;
+}
+
+LogRecord LogRecord::assign(int t, std::string_view ship, CargoType type,
+                            int until) {
+  LogRecord rec = stamped(LogEvent::ASSIGN);
+  rec.time = t;
+  rec.cargo = type;
+  rec.until = until;
+  copyText(rec.name, ship);
+  return rec;
+}
+
+LogRecord LogRecord::finish(int t, std::string_view ship, CargoType type) {
+  LogRecord rec = stamped(LogEvent::FINISH);
+  rec.time = t;
+  rec.cargo = type;
+  copyText(rec.name, ship);
+  return rec;
+}
+
+LogRecord LogRecord::fine(int t, double amount, double total) {
+  LogRecord rec = stamped(LogEvent::FINE);
+  rec.time = t;
+  rec.amount = amount;
+  rec.total = total;
+  return rec;
+}
+
+LogRecord LogRecord::request(std::string_view method, std::string_view path,
+                             int status, double ms) {
+  LogRecord rec = stamped(LogEvent::REQUEST);
+  rec.until = status;
+  rec.amount = ms;
+  copyText(rec.name, method);
+  copyText(rec.text, path);
+  return rec;
+}
+
+// --- приёмники ---
+
+static std::string padded(const char *s, std::size_t width) {
+  std::string out = s;
+  if (out.size() < width)
+    out.append(width - out.size(), ' ');
+  return out;
+}
+
+void TextSink::write(const LogRecord &rec) {
+  const char *on = "", *off = "";
+  auto paint = [&](const char *c) {
+    on = color ? c : "";
+    off = color ? termcolor::reset : "";
+  };
+  char num[64];
+  auto clock = [&] {
+    std::snprintf(num, sizeof num, "🕓 [t=%5d] ", rec.time);
+    buffer += on;
+    buffer += num;
+    buffer += off;
+  };
+  const char *icon = cargoIcons[(int)rec.cargo];
+
+  switch (rec.event) {
+  case LogEvent::MESSAGE:
+    buffer += rec.text;
+    break;
+  case LogEvent::ARRIVE:
+    paint(termcolor::blue);
+    clock();
+    buffer += icon;
+    buffer += " " + padded(rec.name, 10) + " — прибыл в порт (очередь: ";
+    buffer += icon;
+    buffer += ")";
+    break;
+  case LogEvent::ASSIGN:
+    paint(termcolor::cyan);
+    clock();
+    buffer += "🏗 ";
+    buffer += icon;
+    buffer += " Назначен " + padded(rec.name, 10) + " → док ";
+    buffer += cargoNames[(int)rec.cargo];
+    buffer += " (⏱ до " + std::to_string(rec.until) + ")";
+    break;
+  case LogEvent::FINISH:
+    paint(termcolor::green);
+    clock();
+    buffer += "✅ Завершена разгрузка: ";
+    buffer += icon;
+    buffer += " ";
+    buffer += rec.name;
+    break;
+  case LogEvent::FINE:
+    paint(termcolor::yellow);
+    std::snprintf(num, sizeof num, "%g (итого: %g)", rec.amount, rec.total);
+    buffer += on;
+    buffer += "Начислен штраф: +";
+    buffer += num;
+    buffer += off;
+    break;
+  case LogEvent::REQUEST: {
+    std::time_t secs = rec.wall / 1000;
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &secs);
+#else
+    localtime_r(&secs, &tm);
+#endif
+    std::strftime(num, sizeof num, "[%H:%M:%S] ", &tm);
+    paint(termcolor::gray);
+    buffer += on;
+    buffer += num;
+    paint(termcolor::cyan);
+    buffer += on;
+    buffer += rec.name;
+    buffer += " ";
+    buffer += off;
+    buffer += rec.text;
+    buffer += " ";
+    paint(rec.until >= 200 && rec.until < 300 ? termcolor::green
+          : rec.until == 404                  ? termcolor::yellow
+                                              : termcolor::red);
+    buffer += on;
+    buffer += std::to_string(rec.until);
+    buffer += off;
+    std::snprintf(num, sizeof num, " (%.1f ms)", rec.amount);
+    buffer += num;
+    break;
+  }
+  }
+  buffer += '\n';
+}
+
+void TextSink::flush() {
+  out.write(buffer.data(), (std::streamsize)buffer.size());
+  out.flush();
+  buffer.clear();
+}
+
+void JsonSink::write(const LogRecord &rec) {
+  static const char *eventNames[] = {"message", "arrive", "assign",
+                                     "finish",  "fine",   "request"};
+  json j = {{"ts", rec.wall},
+            {"level", levelNames[(int)rec.level]},
+            {"event", eventNames[(int)rec.event]}};
+  switch (rec.event) {
+  case LogEvent::MESSAGE:
+    j["message"] = rec.text;
+    break;
+  case LogEvent::ARRIVE:
+  case LogEvent::FINISH:
+    j["t"] = rec.time;
+    j["ship"] = rec.name;
+    j["type"] = cargoNames[(int)rec.cargo];
+    break;
+  case LogEvent::ASSIGN:
+    j["t"] = rec.time;
+    j["ship"] = rec.name;
+    j["type"] = cargoNames[(int)rec.cargo];
+    j["until"] = rec.until;
+    break;
+  case LogEvent::FINE:
+    j["t"] = rec.time;
+    j["amount"] = rec.amount;
+    j["total"] = rec.total;
+    break;
+  case LogEvent::REQUEST:
+    j["method"] = rec.name;
+    j["path"] = rec.text;
+    j["status"] = rec.until;
+    j["ms"] = rec.amount;
+    break;
+  }
+  buffer += j.dump(-1, ' ', false, json::error_handler_t::replace);
+  buffer += '\n';
+}
+
+void JsonSink::flush() {
+  out.write(buffer.data(), (std::streamsize)buffer.size());
+  out.flush();
+  buffer.clear();
+}
+
+// --- Logger ---
+
+Logger &Logger::get() {
+  static Logger logger;
+  return logger;
+}
+
+Logger::Logger()
+    : ring(new Cell[kCapacity]), sink(std::make_unique<TextSink>()) {
+  for (std::size_t i = 0; i < kCapacity; ++i)
+    ring[i].seq.store(i, std::memory_order_relaxed);
+  writer = std::thread([this] { run(); });
+}
+
+Logger::~Logger() {
+  stop.store(true);
+  writer.join();
+}
+
+void Logger::setSink(std::unique_ptr<LogSink> s) {
+  flush();
+  std::lock_guard<std::mutex> lock(sinkMutex);
+  sink = std::move(s);
+}
+
+void Logger::push(LogLevel l, const LogRecord &rec) {
+  std::uint64_t pos = head.load(std::memory_order_relaxed);
+  Cell *cell;
+  for (;;) {
+    cell = &ring[pos % kCapacity];
+    std::uint64_t seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = (std::int64_t)(seq - pos);
+    if (diff == 0) {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      // кольцо заполнено: запись теряется, но поток не ждёт
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      pos = head.load(std::memory_order_relaxed);
+    }
+  }
+  cell->rec = rec;
+  cell->rec.level = l;
+  cell->seq.store(pos + 1, std::memory_order_release);
+}
+
+bool Logger::pop(LogRecord &rec) {
+  std::uint64_t pos = tail.load(std::memory_order_relaxed);
+  Cell &cell = ring[pos % kCapacity];
+  if (cell.seq.load(std::memory_order_acquire) != pos + 1)
+    return false;
+  rec = cell.rec;
+  cell.seq.store(pos + kCapacity, std::memory_order_release);
+  tail.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+void Logger::flush() {
+  std::uint64_t target = head.load(std::memory_order_acquire);
+  while (written.load(std::memory_order_acquire) < target)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Logger::run() {
+  constexpr int kBatch = 256;
+  std::uint64_t reportedDrops = 0;
+  LogRecord rec;
+  for (;;) {
+    int n = 0;
+    {
+      std::lock_guard<std::mutex> lock(sinkMutex);
+      while (n < kBatch && pop(rec)) {
+        sink->write(rec);
+        ++n;
+      }
+      std::uint64_t drops = dropped();
+      if (drops != reportedDrops) {
+        sink->write(LogRecord::message(
+            "… пропущено сообщений лога: " + std::to_string(drops - reportedDrops)));
+        reportedDrops = drops;
+        ++n;
+      }
+      if (n > 0)
+        sink->flush();
+    }
+    written.store(tail.load(std::memory_order_relaxed),
+                  std::memory_order_release);
+    if (n == 0) {
+      if (stop.load())
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+}
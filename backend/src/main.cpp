@@ -1,17 +1,205 @@
 #include "httplib.h"
 #include "api.hpp"
+#include "journal.hpp"
+#include "log.hpp"
+#include "optimizer.hpp"
+#include "port.hpp"
+#include "schedule_generator.hpp"
+#include "trace.hpp"
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+// backend --optimize spec.json: поиск набора кранов без сервера,
+// результат печатается в stdout. Поле "config" спецификации
+// накладывается на конфигурацию по умолчанию.
+static int runOptimize(const char* path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+    try {
+        json spec = json::parse(in);
+        json cfg = SimulationConfig().to_json();
+        if (spec.contains("config")) {
+            cfg.merge_patch(spec["config"]);
+        }
+        auto result = optimizeCranes(SimulationConfig::from_json(cfg),
+                                     OptimizeSpec::from_json(spec));
+        std::cout << result.to_json().dump(2) << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// backend --replay journal.bin [events]: состояние порта после первых
+// events записей журнала (по умолчанию — после всех).
+static int runReplay(const char* path, const char* events) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+    try {
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        JournalReplayer replayer(std::move(data));
+        Port port;
+        port.logEvents = false;
+        replayer.replay(port, events ? std::stoull(events) : replayer.eventCount());
+        std::cout << port.getState().dump(2) << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// backend --generate spec.json: синтетическое расписание в CSV
+// (name,type,arrival,weight) в stdout, его можно загрузить через --schedule.
+static int runGenerate(const char* path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+    try {
+        auto schedule = generateSchedule(ScheduleSpec::from_json(json::parse(in)));
+        static const char* typeNames[] = {"BULK", "LIQUID", "CONTAINER"};
+        std::string out = "name,type,arrival,weight\n";
+        for (auto const& s : schedule) {
+            out += s.name;
+            out += ',';
+            out += typeNames[(int)s.type];
+            out += ',';
+            out += std::to_string(s.arrival);
+            out += ',';
+            out += std::to_string(s.weight);
+            out += '\n';
+        }
+        std::cout.write(out.data(), out.size());
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// backend --trace config.json trace.json [until]: прогон конфигурации (поля
+// поверх конфигурации по умолчанию) с записью трассы для chrome://tracing
+// или Perfetto; итоги прогона печатаются в stdout.
+static int runTrace(const char* configPath, const char* outPath, const char* until) {
+    std::ifstream in(configPath);
+    if (!in) {
+        std::cerr << "cannot open " << configPath << std::endl;
+        return 1;
+    }
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "cannot create " << outPath << std::endl;
+        return 1;
+    }
+    try {
+        json cfg = SimulationConfig().to_json();
+        cfg.merge_patch(json::parse(in));
+        SimulationConfig config = SimulationConfig::from_json(cfg);
+
+        TraceWriter writer([&out](const std::string& chunk) {
+            out.write(chunk.data(), (std::streamsize)chunk.size());
+        });
+        Port port;
+        port.logEvents = false;
+        port.trace = &writer;
+        port.setConfig(&config);
+        port.reset();
+        port.run(until ? std::stoi(until) : std::numeric_limits<int>::max(),
+                 std::numeric_limits<long long>::max());
+        writer.close();
+
+        json summary = port.summarize().to_json();
+        summary["traceEvents"] = writer.events();
+        std::cout << summary.dump(2) << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --log-level debug|info|...|off, --log-format text|json|plain и
+// --data-dir DIR (каталог расписаний для POST /schedule) можно указать
+// перед любыми другими аргументами.
+static void configureLog(const std::string& flag, const std::string& value) {
+    if (flag == "--log-level") {
+        Logger::get().setLevel(logLevelFromName(value));
+    } else if (value == "json") {
+        Logger::get().setSink(std::make_unique<JsonSink>());
+    } else if (value == "plain") {
+        Logger::get().setSink(std::make_unique<TextSink>(std::cout, false));
+    } else if (value == "text") {
+        Logger::get().setSink(std::make_unique<TextSink>());
+    } else {
+        throw std::invalid_argument("unknown log format: " + value);
+    }
+}
+
+int main(int argc, char** argv) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--log-level" || arg == "--log-format" || arg == "--data-dir") && i + 1 < argc) {
+            try {
+                if (arg == "--data-dir")
+                    set_schedule_dir(argv[++i]);
+                else
+                    configureLog(arg, argv[++i]);
+            } catch (std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+
+    if (argc == 3 && std::string(argv[1]) == "--optimize") {
+        return runOptimize(argv[2]);
+    }
+    if (argc == 3 && std::string(argv[1]) == "--generate") {
+        return runGenerate(argv[2]);
+    }
+    if ((argc == 4 || argc == 5) && std::string(argv[1]) == "--trace") {
+        return runTrace(argv[2], argv[3], argc == 5 ? argv[4] : nullptr);
+    }
+    if ((argc == 3 || argc == 4) && std::string(argv[1]) == "--replay") {
+        return runReplay(argv[2], argc == 4 ? argv[3] : nullptr);
+    }
 
-int main() {
     httplib::Server app;
     setup_routes(app);
 
 
     init_port_from_config();
 
+    // backend --schedule ships.csv: сервер стартует с расписанием из файла
+    if (argc == 3 && std::string(argv[1]) == "--schedule") {
+        try {
+            std::size_t ships = load_schedule_file(argv[2]);
+            SEAPORT_LOG(INFO, LogRecord::message(" Загружено судов: " + std::to_string(ships)));
+        } catch (std::exception& e) {
+            std::cerr << argv[2] << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
 
 
-    std::cout << " 🚢 Портовый сервер http://localhost:3000" << std::endl;
+    SEAPORT_LOG(INFO, LogRecord::message(" 🚢 Портовый сервер http://localhost:3000"));
     app.listen("localhost", 3000);
     return 0;
 }
@@ -0,0 +1,230 @@
+#include "optimizer.hpp"
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+static const char *typeNames[] = {"BULK", "LIQUID", "CONTAINER"};
+
+OptimizeSpec OptimizeSpec::from_json(const json &j) {
+  OptimizeSpec s;
+  s.fineBudget = j.at("fineBudget");
+
+  for (int t = 0; t < 3; ++t) {
+    if (j.contains("bounds") && j["bounds"].contains(typeNames[t])) {
+      auto const &b = j["bounds"][typeNames[t]];
+      s.minCranes[t] = b.at(0);
+      s.maxCranes[t] = b.at(1);
+    }
+    if (j.contains("craneCost") && j["craneCost"].contains(typeNames[t]))
+      s.craneCost[t] = j["craneCost"][typeNames[t]];
+  }
+  if (j.contains("batch")) s.batch = j["batch"];
+  if (j.contains("maxReplications")) s.maxReplications = j["maxReplications"];
+  if (j.contains("confidence")) s.confidence = j["confidence"];
+  if (j.contains("until")) s.until = j["until"];
+
+  for (int t = 0; t < 3; ++t) {
+    if (s.minCranes[t] < 1 || s.minCranes[t] > s.maxCranes[t])
+      throw std::invalid_argument(std::string("invalid crane bounds for ") +
+                                  typeNames[t]);
+  }
+  if (s.batch < 2)
+    throw std::invalid_argument("batch must be at least 2");
+  checkReplicationLimit("batch", s.batch);
+  checkReplicationLimit("maxReplications", s.maxReplications);
+  if (s.maxReplications < s.batch)
+    s.maxReplications = s.batch;
+  return s;
+}
+
+json CandidateResult::to_json() const {
+  static const char *statusNames[] = {"FEASIBLE", "INFEASIBLE", "DOMINATED",
+                                      "UNRESOLVED"};
+  return {{"cranesBulk", cranes[0]},
+          {"cranesLiquid", cranes[1]},
+          {"cranesContainer", cranes[2]},
+          {"cost", cost},
+          {"status", statusNames[(int)status]},
+          {"fine", fine.to_json()}};
+}
+
+json OptimizeResult::to_json() const {
+  json h = json::array();
+  for (auto const &c : history)
+    h.push_back(c.to_json());
+
+  return {{"found", found},
+          {"best", found ? best.to_json() : json(nullptr)},
+          {"candidates", candidates},
+          {"evaluated", evaluated},
+          {"pruned", pruned},
+          {"replications", replications},
+          {"history", h}};
+}
+
+namespace {
+struct Candidate {
+  CandidateResult result;
+  bool settled = false;
+  SimulationConfig cfg;
+  std::vector<RunSummary> runs;
+};
+
+bool notAbove(const Candidate &a, const Candidate &b) {
+  for (int t = 0; t < 3; ++t) {
+    if (a.result.cranes[t] > b.result.cranes[t])
+      return false;
+  }
+  return true;
+}
+} // namespace
+
+OptimizeResult
+optimizeCranes(const SimulationConfig &base, const OptimizeSpec &spec,
+               const std::function<void(const CandidateResult &)> &onCandidate,
+               const std::atomic<bool> *cancel, ThreadPool &pool) {
+  json scalars = base.to_json();
+  scalars.erase("schedule");
+  SimulationConfig skeleton = SimulationConfig::from_json(scalars);
+
+  std::vector<Candidate> all;
+  for (int b = spec.minCranes[0]; b <= spec.maxCranes[0]; ++b) {
+    for (int l = spec.minCranes[1]; l <= spec.maxCranes[1]; ++l) {
+      for (int c = spec.minCranes[2]; c <= spec.maxCranes[2]; ++c) {
+        Candidate cand;
+        cand.result.cranes[0] = b;
+        cand.result.cranes[1] = l;
+        cand.result.cranes[2] = c;
+        cand.result.cost = b * spec.craneCost[0] + l * spec.craneCost[1] +
+                           c * spec.craneCost[2];
+        all.push_back(std::move(cand));
+      }
+    }
+  }
+  std::stable_sort(all.begin(), all.end(),
+                   [](const Candidate &x, const Candidate &y) {
+                     return x.result.cost < y.result.cost;
+                   });
+
+  OptimizeResult out;
+  out.candidates = (int)all.size();
+
+  auto cancelled = [cancel] { return cancel != nullptr && cancel->load(); };
+  auto settle = [&](Candidate &cand, CandidateStatus status) {
+    cand.settled = true;
+    cand.result.status = status;
+    if (status == CandidateStatus::DOMINATED)
+      out.pruned++;
+    out.history.push_back(cand.result);
+    if (onCandidate)
+      onCandidate(cand.result);
+  };
+
+  std::size_t width = std::max(1u, pool.size());
+  while (!cancelled()) {
+    std::vector<Candidate *> wave;
+    for (auto &cand : all) {
+      if (cand.settled)
+        continue;
+      if (out.found && cand.result.cost >= out.best.cost) {
+        settle(cand, CandidateStatus::DOMINATED);
+        continue;
+      }
+      if (wave.size() < width)
+        wave.push_back(&cand);
+    }
+    if (wave.empty())
+      break;
+
+    for (auto *cand : wave) {
+      cand->cfg = skeleton;
+      cand->cfg.cranesBulk = cand->result.cranes[0];
+      cand->cfg.cranesLiquid = cand->result.cranes[1];
+      cand->cfg.cranesContainer = cand->result.cranes[2];
+    }
+
+    // пачки репликаций всех ещё не решённых кандидатов волны идут вместе
+    std::vector<Candidate *> active = wave;
+    while (!active.empty() && !cancelled()) {
+      std::vector<std::future<RunSummary>> pending;
+      std::vector<Candidate *> owners;
+      for (auto *cand : active) {
+        int first = (int)cand->runs.size();
+        int last = std::min(first + spec.batch, spec.maxReplications);
+        for (int r = first; r < last; ++r) {
+          unsigned seed = replicationSeed(base.seed, r);
+          pending.push_back(pool.submit([cand, seed, &spec, &base] {
+            return runReplication(cand->cfg, seed, spec.until, &base.schedule);
+          }));
+          owners.push_back(cand);
+        }
+      }
+      // как и в runSweep: сначала дожидаемся всех задач, потом ошибка
+      std::exception_ptr error;
+      for (std::size_t i = 0; i < pending.size(); ++i) {
+        try {
+          owners[i]->runs.push_back(pending[i].get());
+        } catch (...) {
+          if (!error)
+            error = std::current_exception();
+        }
+      }
+      if (error)
+        std::rethrow_exception(error);
+      out.replications += (long long)pending.size();
+
+      std::vector<Candidate *> still;
+      for (auto *cand : active) {
+        std::vector<double> fines;
+        fines.reserve(cand->runs.size());
+        // прогон, вставший раньше until, недоразгрузил суда: его штраф
+        // перестал расти и ничего не говорит о наборе кранов
+        bool stalled = false;
+        for (auto const &r : cand->runs) {
+          fines.push_back(r.fine);
+          stalled = stalled || (!r.completed && r.now < spec.until);
+        }
+        cand->result.fine = computeStats(std::move(fines), spec.confidence);
+
+        auto const &st = cand->result.fine;
+        bool exhausted = (int)cand->runs.size() >= spec.maxReplications;
+        if (stalled || st.ciLow > spec.fineBudget ||
+            (exhausted && st.mean > spec.fineBudget)) {
+          cand->result.status = CandidateStatus::INFEASIBLE;
+        } else if (st.ciHigh <= spec.fineBudget) {
+          cand->result.status = CandidateStatus::FEASIBLE;
+        } else if (exhausted) {
+          cand->result.status = CandidateStatus::UNRESOLVED;
+        } else {
+          still.push_back(cand);
+          continue;
+        }
+        cand->runs.clear();
+        cand->runs.shrink_to_fit();
+      }
+      active = std::move(still);
+    }
+    if (cancelled())
+      break;
+
+    for (auto *cand : wave) {
+      out.evaluated++;
+      settle(*cand, cand->result.status);
+      if (cand->result.status == CandidateStatus::FEASIBLE &&
+          (!out.found || cand->result.cost < out.best.cost)) {
+        out.found = true;
+        out.best = cand->result;
+      }
+    }
+    for (auto *cand : wave) {
+      if (cand->result.status != CandidateStatus::INFEASIBLE)
+        continue;
+      for (auto &other : all) {
+        if (!other.settled && notAbove(other, *cand))
+          settle(other, CandidateStatus::DOMINATED);
+      }
+    }
+  }
+
+  return out;
+}
@@ -1,30 +1,22 @@
 #include "port.hpp"
+#include "journal.hpp"
+#include "log.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
-
-namespace termcolor {
-constexpr const char *reset = "\033[0m";
-constexpr const char *gray = "\033[90m";
-constexpr const char *cyan = "\033[36m";
-constexpr const char *yellow = "\033[33m";
-constexpr const char *green = "\033[32m";
-constexpr const char *blue = "\033[34m";
-constexpr const char *magenta = "\033[35m";
-} // namespace termcolor
-
-int Port::randomJitter(int left, int right) {
-  if (left > right) {
-    std::swap(left, right);
-  }
-
-  std::uniform_int_distribution<int> dist(left, right);
-  return dist(rng);
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+double Port::draw(std::uint64_t shipKey, DrawPurpose purpose) const {
+  double u = RandomStream{rngSeed, shipKey, purpose}.uniform();
+  return antithetic ? 1.0 - u : u;
 }
 
-int Port::computeUnloadTime(const Ship &ship) {
+int Port::computeUnloadTime(CargoType type, int weight, std::uint64_t shipKey) {
   double rate = 0.0;
-  switch (ship.type) {
+  switch (type) {
   case CargoType::BULK:
     rate = cfg->rateBulk;
     break;
@@ -36,19 +28,26 @@ int Port::computeUnloadTime(const Ship &ship) {
     break;
   }
 
-  int base = static_cast<int>(std::round(ship.weight / rate));
+  int base = static_cast<int>(std::round(weight / rate));
 
   int extra = 0;
   if (cfg->unloadExtraMax > cfg->unloadExtraMin) {
-    extra = randomJitter(cfg->unloadExtraMin, cfg->unloadExtraMax);
+    double u = draw(shipKey, DrawPurpose::UNLOAD_EXTRA);
+    extra = uniformInt(u, cfg->unloadExtraMin, cfg->unloadExtraMax);
   }
 
   return std::max(1, base + extra);
 }
 
-void Port::setConfig(SimulationConfig *conf) {
+void Port::setConfig(const SimulationConfig *conf) {
   cfg = conf;
-  rng.seed(cfg->seed);
+  rngSeed = cfg->seed;
+}
+
+void Port::reseed(unsigned seed) { rngSeed = seed; }
+
+void Port::setSchedule(const std::vector<SimulationConfig::ShipPlan> *schedule) {
+  plans = schedule;
 }
 
 void Port::reset() {
@@ -56,19 +55,25 @@ void Port::reset() {
     return;
   }
 
+  // версия не сбрасывается: клиенты с версией до reset получат всё заново
+  layoutVersion = ++version;
   now = 0;
   fine = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    fineByType[i] = 0.0;
+    waiting[i] = 0;
+  }
   ships.clear();
   cranes.clear();
-  while (!qBulk.empty()) {
-    qBulk.pop();
-  }
-  while (!qLiquid.empty()) {
-    qLiquid.pop();
-  }
-  while (!qContainer.empty()) {
-    qContainer.pop();
-  }
+  qBulk.clear();
+  qLiquid.clear();
+  qContainer.clear();
+  completions = {};
+  finishedBatch.clear();
+  arrivalOrder.clear();
+  arrivalCursor = 0;
+  startedCount = 0;
+  finishedCount = 0;
 
   // --- создаём краны ---
   for (int i = 0; i < cfg->cranesBulk; ++i) {
@@ -80,30 +85,55 @@ void Port::reset() {
   for (int i = 0; i < cfg->cranesContainer; ++i) {
     cranes.push_back({CargoType::CONTAINER, false, 0});
   }
+  rebuildFreeCranes();
+
+  auto const &schedule = plans != nullptr ? *plans : cfg->schedule;
+  ships.reserve(schedule.size());
+  // выборки судна зависят только от его плана, порядок обхода не важен
+  for (auto const &plan : schedule) {
+    std::uint64_t key = shipStreamKey(plan.name, plan.arrival, plan.weight,
+                                      (int)plan.type);
+    double u = draw(key, DrawPurpose::ARRIVAL_JITTER);
+    int actualArrival =
+        std::max(0, plan.arrival + uniformInt(u, cfg->arrivalJitterMin,
+                                              cfg->arrivalJitterMax));
+    int unloadTime = computeUnloadTime(plan.type, plan.weight, key);
+    ships.add({plan.name, plan.arrival, plan.weight}, plan.type, actualArrival,
+              unloadTime);
+  }
+
+  sortArrivals();
 
-  for (auto const &plan : cfg->schedule) {
-    Ship ship;
-    ship.name = plan.name;
-    ship.type = plan.type;
-    ship.arrival = plan.arrival;
-    ship.weight = plan.weight;
-    ship.actualArrival =
-        std::max(0, ship.arrival + randomJitter(cfg->arrivalJitterMin,
-                                                cfg->arrivalJitterMax));
-    ship.unloadTime = computeUnloadTime(ship);
-    ships.push_back(ship);
+  if (journal != nullptr) {
+    journal->begin(*this);
+  }
+  if (trace != nullptr) {
+    trace->begin(*this);
   }
 
-  std::cout << "\n⚓ Порт инициализирован\n";
-  std::cout << "───────────────────────────────────────────────\n";
-  std::cout << "📦 Кораблей: " << ships.size()
-            << "   ⚙️  Кранов: " << cranes.size() << "\n";
-  std::cout << "───────────────────────────────────────────────\n";
+  if (!logEvents) {
+    return;
+  }
 
-  for (auto const &shipEl : ships) {
+  auto line = [](const std::string &text) {
+    SEAPORT_LOG(INFO, LogRecord::message(text));
+  };
+  const std::string rule = "───────────────────────────────────────────────";
+  line("");
+  line("⚓ Порт инициализирован");
+  line(rule);
+  line("📦 Кораблей: " + std::to_string(ships.size()) +
+       "   ⚙️  Кранов: " + std::to_string(cranes.size()));
+  line(rule);
+
+  // большие расписания (из файла) печатаем только началом
+  constexpr int kListedShips = 50;
+  int listed = std::min<int>(ships.size(), kListedShips);
+  for (int i = 0; i < listed; ++i) {
+    auto const &shipEl = ships.info[i];
     std::string typeIcon;
     std::string typeName;
-    switch (shipEl.type) {
+    switch (ships.type[i]) {
     case CargoType::BULK:
       typeIcon = "⛏";
       typeName = "BULK";
@@ -118,21 +148,48 @@ void Port::reset() {
       break;
     }
 
-    std::cout << typeIcon << " " << std::setw(10) << std::left << shipEl.name
-              << " | " << std::setw(10) << std::left << typeName
-              << " | Прибытие: " << std::setw(5) << shipEl.arrival << " → "
-              << std::setw(5) << shipEl.actualArrival
-              << " | Вес: " << std::setw(7) << shipEl.weight
-              << " | Разгрузка: " << shipEl.unloadTime << " мин"
-              << "\n";
-  }
-
-  std::cout << "───────────────────────────────────────────────\n";
-  std::cout << " Краны:\n";
-  std::cout << "  • BULK: " << cfg->cranesBulk << "\n";
-  std::cout << "  • LIQUID: " << cfg->cranesLiquid << "\n";
-  std::cout << "  • CONTAINER: " << cfg->cranesContainer << "\n";
-  std::cout << "───────────────────────────────────────────────\n\n";
+    std::ostringstream os;
+    os << typeIcon << " " << std::setw(10) << std::left << shipEl.name
+       << " | " << std::setw(10) << std::left << typeName
+       << " | Прибытие: " << std::setw(5) << shipEl.arrival << " → "
+       << std::setw(5) << ships.actualArrival[i]
+       << " | Вес: " << std::setw(7) << shipEl.weight
+       << " | Разгрузка: " << ships.unloadTime[i] << " мин";
+    line(os.str());
+  }
+  if (listed < ships.size()) {
+    line("  … и ещё " + std::to_string(ships.size() - listed));
+  }
+
+  line(rule);
+  line(" Краны:");
+  line("  • BULK: " + std::to_string(cfg->cranesBulk));
+  line("  • LIQUID: " + std::to_string(cfg->cranesLiquid));
+  line("  • CONTAINER: " + std::to_string(cfg->cranesContainer));
+  line(rule);
+  line("");
+}
+
+void Port::sortArrivals() {
+  std::vector<int> order(ships.size());
+  for (int i = 0; i < ships.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return ships.actualArrival[a] < ships.actualArrival[b];
+  });
+  arrivalOrder = order;
+}
+
+void Port::rebuildFreeCranes() {
+  for (auto &pool : freeCranes) {
+    pool = {};
+  }
+  for (int i = 0; i < (int)cranes.size(); ++i) {
+    if (!cranes[i].busy) {
+      releaseCrane(i);
+    }
+  }
 }
 
 void Port::simulateStep(int delta) {
@@ -140,13 +197,15 @@ void Port::simulateStep(int delta) {
     return;
   }
 
+  if (cfg->engine == EngineMode::NEXT_EVENT) {
+    advanceTo(now + delta);
+    return;
+  }
+
+  ++version;
   now += delta;
 
-  for (auto &craneEl : cranes) {
-    if (craneEl.busy && craneEl.busyUntil <= now) {
-      craneEl.busy = false;
-    }
-  }
+  releaseCranes();
 
   enqueueArrivals();
 
@@ -154,172 +213,444 @@ void Port::simulateStep(int delta) {
 
   completeFinished();
 
-  accrueFine();
+  logFine(accrueFine(delta));
+
+  if (journal != nullptr)
+    journal->checkpoint(*this);
 }
 
 void Port::enqueueArrivals() {
+  std::size_t first = arrivalCursor;
+  while (arrivalCursor < arrivalOrder.size() &&
+         ships.actualArrival[arrivalOrder[arrivalCursor]] <= now) {
+    ++arrivalCursor;
+  }
+  if (first == arrivalCursor) {
+    return;
+  }
 
-  for (int i = 0; i < (int)ships.size(); ++i) {
-    auto &s = ships[i];
-    if (!s.finished && !s.unloading && !s.inQueue && s.actualArrival <= now) {
-      s.inQueue = true;
-      switch (s.type) {
-      case CargoType::BULK:
-        qBulk.push(i);
-        break;
-      case CargoType::LIQUID:
-        qLiquid.push(i);
-        break;
-      case CargoType::CONTAINER:
-        qContainer.push(i);
-        break;
-      }
+  // суда, прибывшие за один шаг, встают в очередь в порядке расписания
+  arrivalBatch.clear();
+  for (std::size_t i = first; i < arrivalCursor; ++i) {
+    arrivalBatch.push_back(arrivalOrder[i]);
+  }
+  std::sort(arrivalBatch.begin(), arrivalBatch.end());
+  for (int idx : arrivalBatch) {
+    arrive(idx);
+  }
+  if (trace != nullptr)
+    trace->queues(now, waiting);
+}
+
+void Port::arrive(int idx) {
+  CargoType type = ships.type[idx];
+  ships.state.mut(idx) = ShipState::QUEUED;
+  touchShip(idx);
+  switch (type) {
+  case CargoType::BULK:
+    qBulk.push(idx);
+    break;
+  case CargoType::LIQUID:
+    qLiquid.push(idx);
+    break;
+  case CargoType::CONTAINER:
+    qContainer.push(idx);
+    break;
+  }
+  waiting[(int)type]++;
 
-      std::string typeIcon = (s.type == CargoType::BULK)     ? "⛏"
-                        : (s.type == CargoType::LIQUID) ? "🛢"
-                                                        : "📦";
+  if (journal != nullptr)
+    journal->arrive(now, idx);
+  if (trace != nullptr)
+    trace->arrive(ships.actualArrival[idx], ships.info[idx].name, type);
 
-        std::cout << termcolor::blue << "🕓 [t=" << std::setw(5) << now << "] " << termcolor::reset
-           << typeIcon << " " << std::setw(10) << std::left << s.name
-           << " — прибыл в порт (очередь: " << typeIcon << ")" << '\n';
-    }
+  if (!logEvents)
+    return;
+
+  SEAPORT_LOG(DEBUG, LogRecord::arrival(now, ships.info[idx].name, type));
+}
+
+ShipQueue &Port::queueFor(CargoType t) {
+  if (t == CargoType::BULK)
+    return qBulk;
+  if (t == CargoType::LIQUID)
+    return qLiquid;
+  return qContainer;
+}
+
+void Port::releaseCrane(int ci) {
+  auto &c = cranes.mut(ci);
+  c.busy = false;
+  c.version = version;
+
+  long long key = ci;
+  switch (cfg->cranePolicy) {
+  case CranePolicy::LOWEST_INDEX:
+    break;
+  case CranePolicy::EARLIEST_FREED:
+    key = c.busyUntil;
+    break;
+  case CranePolicy::LEAST_UTILIZED:
+    key = c.busyMinutes;
+    break;
   }
+  freeCranes[(int)c.type].push({key, ci});
 }
 
 void Port::tryAssignCranes() {
-
-  auto popQ = [&](CargoType t, int &idx) -> bool {
-    std::queue<int> *q = nullptr;
-    if (t == CargoType::BULK)
-      q = &qBulk;
-    else if (t == CargoType::LIQUID)
-      q = &qLiquid;
-    else
-      q = &qContainer;
-
-    while (!q->empty()) {
-      int front = q->front();
-      q->pop();
-      auto &s = ships[front];
-      if (s.unloading || s.finished || s.assigned)
+  for (int t = 0; t < 3; ++t) {
+    auto &pool = freeCranes[t];
+    auto &q = queueFor((CargoType)t);
+
+    while (!pool.empty() && !q.empty()) {
+      int ci = pool.top().second;
+      pool.pop();
+      int idx = q.front();
+      q.pop();
+
+      auto &c = cranes.mut(ci);
+
+      waiting[t]--;
+      ships.state.mut(idx) = ShipState::UNLOADING;
+      ships.startUnload.mut(idx) = now;
+      touchShip(idx);
+      int finish = ships.finish(idx);
+
+      c.busy = true;
+      c.busyUntil = finish;
+      c.busyMinutes += ships.unloadTime[idx];
+      c.version = version;
+
+      ++startedCount;
+      completions.push({finish, idx, ci});
+
+      if (journal != nullptr)
+        journal->assign(now, idx, ci);
+      if (trace != nullptr)
+        trace->startUnload(now, ci, ships.info[idx].name);
+
+      if (!logEvents)
         continue;
-      idx = front;
-      return true;
+
+      SEAPORT_LOG(DEBUG,
+                  LogRecord::assign(now, ships.info[idx].name, c.type, finish));
     }
+  }
+  if (trace != nullptr)
+    trace->queues(now, waiting);
+}
+
+// Снимает с кучи все разгрузки, окончившиеся к now: краны освобождаются
+// сразу, а суда помечаются завершёнными в completeFinished после назначения.
+void Port::releaseCranes() {
+  while (!completions.empty() && completions.top().time <= now) {
+    Completion c = completions.top();
+    completions.pop();
+    releaseCrane(c.crane);
+    finishedBatch.push_back(c.ship);
+    if (journal != nullptr)
+      journal->finish(now, c.ship, c.crane);
+    // конец интервала — точное время окончания, даже если шаг его перешагнул
+    if (trace != nullptr)
+      trace->finishUnload(c.time, c.crane);
+  }
+}
+
+void Port::completeFinished() {
+  for (int idx : finishedBatch) {
+    finishUnload(idx);
+  }
+  finishedBatch.clear();
+}
+
+void Port::finishUnload(int idx) {
+  ships.state.mut(idx) = ShipState::FINISHED;
+  touchShip(idx);
+  ++finishedCount;
+
+  if (!logEvents)
+    return;
+
+  SEAPORT_LOG(DEBUG,
+              LogRecord::finish(now, ships.info[idx].name, ships.type[idx]));
+}
+
+// Штраф за minutes минут при неизменных очередях: счётчики ожидающих судов
+// меняются только при постановке в очередь и назначении крана.
+double Port::accrueFine(int minutes) {
+  double amount = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    double part = cfg->finePerMinute * waiting[i] * minutes;
+    fineByType[i] += part;
+    amount += part;
+  }
+  fine += amount;
+  if (journal != nullptr && amount != 0.0)
+    journal->fine(now, minutes);
+  return amount;
+}
+
+void Port::logFine(double amount) const {
+  if (amount <= 0.0 || !logEvents)
+    return;
+
+  SEAPORT_LOG(DEBUG, LogRecord::fine(now, amount, fine));
+}
+
+int Port::waitingCount() const { return waiting[0] + waiting[1] + waiting[2]; }
+
+int Port::nextEventTime() const {
+  int t = std::numeric_limits<int>::max();
+  if (arrivalCursor < arrivalOrder.size())
+    t = ships.actualArrival[arrivalOrder[arrivalCursor]];
+  if (!completions.empty())
+    t = std::min(t, completions.top().time);
+  if (t == std::numeric_limits<int>::max())
+    return t;
+  return std::max(now + 1, t);
+}
+
+// Один шаг событийного режима: штраф за минуты без событий начисляется по
+// текущей длине очередей, затем обрабатываются все события момента t так же,
+// как их обработал бы пошаговый режим с step = 1.
+bool Port::advanceToNextEvent(int limit) {
+  if (cfg == nullptr)
     return false;
-  };
 
-  for (auto &c : cranes) {
-    if (c.busy)
-      continue;
+  int t = nextEventTime();
+  if (t > limit)
+    return false;
+  ++version;
 
-    int idx = -1;
-    if (!popQ(c.type, idx))
-      continue;
-    auto &s = ships[idx];
-    if (s.unloading || s.finished || s.assigned)
-      continue;
+  // очереди до событий момента t не меняются, так что штраф за минуты
+  // между событиями можно начислить уже с отметкой t
+  int gap = t - now - 1;
+  now = t;
+  double accrued = accrueFine(gap);
 
-    s.inQueue = false;
-    s.unloading = true;
-    s.assigned = true;
-    s.startUnload = now;
-    s.finish = now + s.unloadTime;
+  releaseCranes();
 
-    c.busy = true;
-    c.busyUntil = *s.finish;
+  enqueueArrivals();
+
+  tryAssignCranes();
 
-    std::string typeStr = (c.type == CargoType::BULK)     ? "BULK"
-                     : (c.type == CargoType::LIQUID) ? "LIQUID"
-                                                     : "CONTAINER";
+  completeFinished();
 
-    std::string typeIcon = (c.type == CargoType::BULK)     ? "⛏"
-                      : (c.type == CargoType::LIQUID) ? "🛢"
-                                                      : "📦";
+  accrued += accrueFine(1);
+  logFine(accrued);
 
-    std::cout << termcolor::cyan << "🕓 [t=" << std::setw(5) << now << "] " << termcolor::reset
-         << "🏗 " << typeIcon << " Назначен " << std::setw(10) << std::left << s.name
-         << " → док " << typeStr << " (⏱ до " << *s.finish << ")" << '\n';
+  if (journal != nullptr)
+    journal->checkpoint(*this);
+  return true;
+}
+
+void Port::advanceTo(int target) {
+  if (cfg == nullptr)
+    return;
+
+  while (advanceToNextEvent(target)) {
+  }
+
+  if (target > now) {
+    int minutes = target - now;
+    ++version;
+    now = target;
+    logFine(accrueFine(minutes));
+    if (journal != nullptr)
+      journal->checkpoint(*this);
   }
 }
 
-void Port::completeFinished() {
-  for (auto &s : ships) {
-    if (s.unloading && s.finish && *s.finish <= now) {
-      s.unloading = false;
-      s.finished = true;
-      s.assigned = false;
-
-      std::string icon = (s.type == CargoType::BULK)     ? "⛏"
-                    : (s.type == CargoType::LIQUID) ? "🛢"
-                                                    : "📦";
-
-      std::cout << termcolor::green << "🕓 [t=" << std::setw(5) << now << "] " << termcolor::reset
-           << "✅ Завершена разгрузка: " << icon << " " << s.name << '\n';
+bool Port::done() const { return finishedCount == ships.size(); }
+
+// Все суда уже в порту, ни одно не разгружается, но и не завершено —
+// значит, для оставшихся типов груза нет кранов и состояние больше не изменится.
+bool Port::stalled() const {
+  return !done() && arrivalCursor == arrivalOrder.size() &&
+         startedCount == finishedCount;
+}
+
+// Прогон до завершения всех разгрузок, момента until или лимита maxEvents
+// (в режиме FIXED_STEP считаются шаги). Возвращает число обработанных событий.
+long long Port::run(int until, long long maxEvents) {
+  if (cfg == nullptr)
+    return 0;
+
+  long long processed = 0;
+  while (!done() && processed < maxEvents && now < until) {
+    if (cfg->engine == EngineMode::NEXT_EVENT) {
+      if (!advanceToNextEvent(until)) {
+        if (until != std::numeric_limits<int>::max())
+          advanceTo(until);
+        break;
+      }
+    } else {
+      if (stalled() && until == std::numeric_limits<int>::max())
+        break;
+      int dt = std::min(cfg->step, until - now);
+      // шаг, не сдвигающий время, повторялся бы без конца
+      if (dt <= 0)
+        throw std::logic_error("simulation step must be positive");
+      simulateStep(dt);
     }
+    ++processed;
+  }
+  return processed;
+}
+
+RunSummary Port::summarize() const {
+  RunSummary r;
+  r.now = now;
+  r.fine = fine;
+  r.shipsTotal = ships.size();
+  r.shipsFinished = finishedCount;
+  r.completed = done();
+
+  for (auto const &c : cranes)
+    r.byType[(int)c.type].cranes++;
+
+  for (int i = 0; i < ships.size(); ++i) {
+    auto &t = r.byType[(int)ships.type[i]];
+    t.ships++;
+    if (ships.state[i] == ShipState::FINISHED)
+      r.makespan = std::max(r.makespan, ships.finish(i));
+    int start = ships.startUnload[i];
+    if (start == kNoTime)
+      continue;
+
+    int wait = start - ships.actualArrival[i];
+    t.served++;
+    t.totalWait += wait;
+    t.maxWait = std::max(t.maxWait, wait);
+    t.busyMinutes += std::min(ships.finish(i), now) - start;
+  }
+  return r;
+}
+
+double RunSummary::meanWait() const {
+  long long wait = 0;
+  int served = 0;
+  for (auto const &t : byType) {
+    wait += t.totalWait;
+    served += t.served;
   }
+  return served ? (double)wait / served : 0.0;
 }
 
-void Port::accrueFine() {
-  double prevFine = fine;
-  for (auto const &s : ships)
-    if (!s.finished && !s.unloading && s.actualArrival <= now)
-      fine += cfg->finePerMinute * cfg->step;
+double RunSummary::utilization() const {
+  long long busy = 0;
+  int cranes = 0;
+  for (auto const &t : byType) {
+    busy += t.busyMinutes;
+    cranes += t.cranes;
+  }
+  return (cranes > 0 && now > 0) ? (double)busy / ((double)cranes * now) : 0.0;
+}
 
-  if (fine > prevFine) {
-    std::cout << termcolor::yellow << "Начислен штраф: +" << (fine - prevFine)
-         << " (итого: " << fine << ")" << termcolor::reset << '\n';
+json RunSummary::to_json() const {
+  static const char *names[] = {"BULK", "LIQUID", "CONTAINER"};
+
+  json types = json::object();
+  for (int i = 0; i < 3; ++i) {
+    auto const &t = byType[i];
+    types[names[i]] = {{"ships", t.ships},
+                       {"served", t.served},
+                       {"meanWait", t.meanWait()},
+                       {"maxWait", t.maxWait},
+                       {"totalWait", t.totalWait},
+                       {"cranes", t.cranes},
+                       {"utilization", t.utilization(now)}};
   }
+
+  return {{"now", now},
+          {"fine", fine},
+          {"makespan", makespan},
+          {"shipsTotal", shipsTotal},
+          {"shipsFinished", shipsFinished},
+          {"completed", completed},
+          {"events", events},
+          {"meanWait", meanWait()},
+          {"utilization", utilization()},
+          {"byType", types}};
 }
 
-json Port::getState() const {
+json Port::getState(std::uint64_t since) const {
+  static const char *stateNames[] = {"EN_ROUTE", "QUEUED", "UNLOADING",
+                                     "FINISHED"};
+  // полное состояние — без since, после перестройки или для чужой версии;
+  // иначе только изменившиеся суда и краны, а производные поля
+  // (timeToArrival, timeToFinish, currentFine) остальных клиент
+  // досчитывает по now и finePerMinute
+  bool full = since == 0 || since < layoutVersion || since > version;
   json shipsJson = json::array();
 
-  for (auto const &s : ships) {
-    int timeToArrival = std::max(0, s.actualArrival - now);
+  for (int i = 0; i < ships.size(); ++i) {
+    if (!full && ships.version[i] <= since)
+      continue;
+
+    auto const &info = ships.info[i];
+    CargoType type = ships.type[i];
+    ShipState state = ships.state[i];
+    int actualArrival = ships.actualArrival[i];
+    int finish = ships.finish(i);
+
+    int timeToArrival = std::max(0, actualArrival - now);
     int timeToFinish = 0;
 
-    if (s.unloading && s.finish && *s.finish > now)
-      timeToFinish = *s.finish - now;
+    if (state == ShipState::UNLOADING && finish > now)
+      timeToFinish = finish - now;
 
     double currentFine = 0.0;
-    if (s.inQueue && s.actualArrival <= now)
-      currentFine = (now - s.actualArrival) * cfg->finePerMinute;
+    if (state == ShipState::QUEUED && actualArrival <= now)
+      currentFine = (now - actualArrival) * cfg->finePerMinute;
 
     shipsJson.push_back(
-        {{"name", s.name},
-         {"type", (s.type == CargoType::BULK     ? "BULK"
-                   : s.type == CargoType::LIQUID ? "LIQUID"
-                                                 : "CONTAINER")},
-         {"arrival", s.arrival},
-         {"actualArrival", s.actualArrival},
-         {"weight", s.weight},
-         {"unloadTime", s.unloadTime},
-         {"inQueue", s.inQueue},
-         {"unloading", s.unloading},
-         {"finished", s.finished},
-         {"startUnload", s.startUnload ? *s.startUnload : -1},
-         {"finish", s.finish ? *s.finish : -1},
+        {{"id", i},
+         {"name", info.name},
+         {"type", (type == CargoType::BULK     ? "BULK"
+                   : type == CargoType::LIQUID ? "LIQUID"
+                                               : "CONTAINER")},
+         {"arrival", info.arrival},
+         {"actualArrival", actualArrival},
+         {"weight", info.weight},
+         {"unloadTime", ships.unloadTime[i]},
+         {"state", stateNames[(int)state]},
+         {"inQueue", state == ShipState::QUEUED},
+         {"unloading", state == ShipState::UNLOADING},
+         {"finished", state == ShipState::FINISHED},
+         {"startUnload", ships.startUnload[i]},
+         {"finish", finish},
          {"timeToArrival", timeToArrival},
          {"timeToFinish", timeToFinish},
          {"currentFine", currentFine}});
   }
 
   json cranesJson = json::array();
-  for (auto const &c : cranes) {
+  for (int i = 0; i < (int)cranes.size(); ++i) {
+    auto const &c = cranes[i];
+    if (!full && c.version <= since)
+      continue;
     cranesJson.push_back(
-        {{"type", (c.type == CargoType::BULK     ? "BULK"
+        {{"id", i},
+         {"type", (c.type == CargoType::BULK     ? "BULK"
                    : c.type == CargoType::LIQUID ? "LIQUID"
                                                  : "CONTAINER")},
          {"busy", c.busy},
          {"busyUntil", c.busyUntil}});
   }
 
-  return {{"now", now},
+  return {{"version", version},
+          {"full", full},
+          {"now", now},
           {"fine", fine},
+          {"finePerMinute", cfg != nullptr ? cfg->finePerMinute : 0.0},
+          {"step", cfg != nullptr ? cfg->step : 0},
           {"ships", shipsJson},
           {"cranes", cranesJson},
           {"queueBulk", qBulk.size()},
           {"queueLiquid", qLiquid.size()},
-          {"queueContainer", qContainer.size()}};
+          {"queueContainer", qContainer.size()},
+          {"fineBulk", fineByType[(int)CargoType::BULK]},
+          {"fineLiquid", fineByType[(int)CargoType::LIQUID]},
+          {"fineContainer", fineByType[(int)CargoType::CONTAINER]}};
 }
@@ -0,0 +1,303 @@
+#include "replication.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+double kpiValue(const RunSummary &run, Kpi kpi) {
+  switch (kpi) {
+  case Kpi::FINE:
+    return run.fine;
+  case Kpi::MEAN_WAIT:
+    return run.meanWait();
+  case Kpi::UTILIZATION:
+    return run.utilization();
+  case Kpi::MAKESPAN:
+    return run.makespan;
+  }
+  return 0.0;
+}
+
+const char *kpiName(Kpi kpi) {
+  switch (kpi) {
+  case Kpi::FINE:
+    return "fine";
+  case Kpi::MEAN_WAIT:
+    return "meanWait";
+  case Kpi::UTILIZATION:
+    return "utilization";
+  case Kpi::MAKESPAN:
+    return "makespan";
+  }
+  return "fine";
+}
+
+Kpi kpiFromName(const std::string &name) {
+  if (name == "meanWait")
+    return Kpi::MEAN_WAIT;
+  if (name == "utilization")
+    return Kpi::UTILIZATION;
+  if (name == "makespan")
+    return Kpi::MAKESPAN;
+  return Kpi::FINE;
+}
+
+json SampleStats::to_json() const {
+  return {{"n", n},
+          {"mean", mean},
+          {"stddev", stddev},
+          {"halfWidth", halfWidth},
+          {"ciLow", ciLow},
+          {"ciHigh", ciHigh},
+          {"min", min},
+          {"max", max},
+          {"p5", p5},
+          {"p25", p25},
+          {"p50", p50},
+          {"p75", p75},
+          {"p95", p95}};
+}
+
+// Обратная функция стандартного нормального распределения (Acklam).
+static double normalQuantile(double p) {
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                             -2.759285104469687e+02, 1.383577518672690e+02,
+                             -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                             -1.556989798598866e+02, 6.680131188771972e+01,
+                             -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                             -2.400758277161838e+00, -2.549732539343734e+00,
+                             4.374664141464968e+00,  2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                             2.445134137142996e+00, 3.754408661907416e+00};
+  const double low = 0.02425;
+
+  if (p <= 0.0)
+    return -INFINITY;
+  if (p >= 1.0)
+    return INFINITY;
+
+  if (p < low) {
+    double q = std::sqrt(-2 * std::log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+            c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  if (p > 1 - low) {
+    double q = std::sqrt(-2 * std::log(1 - p));
+    return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+             c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+
+  double q = p - 0.5;
+  double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+         q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// Квантиль распределения Стьюдента: точные формулы для df = 1, 2,
+// разложение Корниша — Фишера для остальных.
+double studentQuantile(double p, int df) {
+  if (df <= 0)
+    return NAN;
+  if (df == 1)
+    return std::tan(M_PI * (p - 0.5));
+  if (df == 2)
+    return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+
+  double z = normalQuantile(p);
+  double z3 = z * z * z;
+  double z5 = z3 * z * z;
+  double z7 = z5 * z * z;
+  double z9 = z7 * z * z;
+  double n = df;
+  return z + (z3 + z) / (4 * n) + (5 * z5 + 16 * z3 + 3 * z) / (96 * n * n) +
+         (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * n * n * n) +
+         (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) /
+             (92160 * n * n * n * n);
+}
+
+static double percentile(const std::vector<double> &sorted, double q) {
+  if (sorted.empty())
+    return 0.0;
+  double pos = q * (double)(sorted.size() - 1);
+  auto lo = (std::size_t)std::floor(pos);
+  auto hi = std::min(lo + 1, sorted.size() - 1);
+  return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - (double)lo);
+}
+
+SampleStats computeStats(std::vector<double> samples, double confidence) {
+  SampleStats st;
+  st.n = (int)samples.size();
+  if (samples.empty())
+    return st;
+
+  double sum = 0.0;
+  for (double v : samples)
+    sum += v;
+  st.mean = sum / st.n;
+
+  double sq = 0.0;
+  for (double v : samples)
+    sq += (v - st.mean) * (v - st.mean);
+  st.stddev = st.n > 1 ? std::sqrt(sq / (st.n - 1)) : 0.0;
+
+  if (st.n > 1) {
+    double t = studentQuantile(0.5 + confidence / 2, st.n - 1);
+    st.halfWidth = t * st.stddev / std::sqrt((double)st.n);
+  }
+  st.ciLow = st.mean - st.halfWidth;
+  st.ciHigh = st.mean + st.halfWidth;
+
+  std::sort(samples.begin(), samples.end());
+  st.min = samples.front();
+  st.max = samples.back();
+  st.p5 = percentile(samples, 0.05);
+  st.p25 = percentile(samples, 0.25);
+  st.p50 = percentile(samples, 0.50);
+  st.p75 = percentile(samples, 0.75);
+  st.p95 = percentile(samples, 0.95);
+  return st;
+}
+
+void checkReplicationLimit(const char *name, int value) {
+  if (value > ReplicationOptions::kMaxReplications)
+    throw std::invalid_argument(
+        std::string(name) + " must not exceed " +
+        std::to_string(ReplicationOptions::kMaxReplications));
+}
+
+ReplicationOptions ReplicationOptions::from_json(const json &j) {
+  ReplicationOptions o;
+  if (j.contains("replications")) o.replications = j["replications"];
+  if (j.contains("confidence")) o.confidence = j["confidence"];
+  if (j.contains("until")) o.until = j["until"];
+  if (j.contains("targetHalfWidth")) o.targetHalfWidth = j["targetHalfWidth"];
+  if (j.contains("targetRelative")) o.targetRelative = j["targetRelative"];
+  if (j.contains("kpi")) o.kpi = kpiFromName(j["kpi"]);
+  if (j.contains("batch")) o.batch = j["batch"];
+  if (j.contains("maxReplications")) o.maxReplications = j["maxReplications"];
+  if (!j.contains("replications") && o.sequential())
+    o.replications = 10;
+  checkReplicationLimit("replications", o.replications);
+  checkReplicationLimit("batch", o.batch);
+  checkReplicationLimit("maxReplications", o.maxReplications);
+  return o;
+}
+
+bool ReplicationOptions::targetReached(const SampleStats &st) const {
+  if (st.n < 2)
+    return false;
+  if (targetHalfWidth > 0 && st.halfWidth > targetHalfWidth)
+    return false;
+  if (targetRelative > 0 && st.halfWidth > targetRelative * std::abs(st.mean))
+    return false;
+  return true;
+}
+
+json ReplicationResult::to_json() const {
+  json j{{"replications", replications},
+         {"confidence", confidence},
+         {"fine", fine.to_json()},
+         {"meanWait", meanWait.to_json()},
+         {"utilization", utilization.to_json()},
+         {"makespan", makespan.to_json()}};
+  if (sequential)
+    j["converged"] = converged;
+  return j;
+}
+
+// splitmix64: соседние номера репликаций дают несвязанные зёрна.
+unsigned replicationSeed(int baseSeed, int replication) {
+  std::uint64_t z = ((std::uint64_t)(std::uint32_t)baseSeed << 32) +
+                    (std::uint64_t)replication + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z = z ^ (z >> 31);
+  return (unsigned)(z >> 32);
+}
+
+RunSummary runReplication(
+    const SimulationConfig &cfg, unsigned seed, int until,
+    const std::vector<SimulationConfig::ShipPlan> *schedule, bool antithetic) {
+  Port port;
+  port.logEvents = false;
+  port.antithetic = antithetic;
+  port.setConfig(&cfg);
+  port.setSchedule(schedule);
+  port.reseed(seed);
+  port.reset();
+
+  long long events = port.run(until, std::numeric_limits<long long>::max());
+  RunSummary summary = port.summarize();
+  summary.events = events;
+  return summary;
+}
+
+ReplicationResult summarizeReplications(const std::vector<RunSummary> &runs,
+                                        double confidence) {
+  auto collect = [&](Kpi kpi) {
+    std::vector<double> values;
+    values.reserve(runs.size());
+    for (auto const &r : runs)
+      values.push_back(kpiValue(r, kpi));
+    return computeStats(std::move(values), confidence);
+  };
+
+  ReplicationResult res;
+  res.replications = (int)runs.size();
+  res.confidence = confidence;
+  res.fine = collect(Kpi::FINE);
+  res.meanWait = collect(Kpi::MEAN_WAIT);
+  res.utilization = collect(Kpi::UTILIZATION);
+  res.makespan = collect(Kpi::MAKESPAN);
+  return res;
+}
+
+ReplicationResult replicate(const SimulationConfig &cfg,
+                            const ReplicationOptions &opt, ThreadPool &pool) {
+  int first = opt.sequential() ? std::min(opt.replications, opt.maxReplications)
+                               : opt.replications;
+  int batch = opt.batch > 0 ? opt.batch : std::max(2u, pool.size());
+
+  std::vector<RunSummary> runs;
+  auto launch = [&](int count) {
+    std::vector<std::future<RunSummary>> pending;
+    pending.reserve(std::max(0, count));
+    for (int i = 0; i < count; ++i) {
+      unsigned seed = replicationSeed(cfg.seed, (int)runs.size() + i);
+      pending.push_back(pool.submit(
+          [&cfg, seed, &opt] { return runReplication(cfg, seed, opt.until); }));
+    }
+    for (auto &f : pending)
+      runs.push_back(f.get());
+  };
+
+  launch(first);
+  if (!opt.sequential())
+    return summarizeReplications(runs, opt.confidence);
+
+  // последовательная остановка: добавляем пачки, пока интервал широк
+  auto kpiStats = [&] {
+    std::vector<double> values;
+    values.reserve(runs.size());
+    for (auto const &r : runs)
+      values.push_back(kpiValue(r, opt.kpi));
+    return computeStats(std::move(values), opt.confidence);
+  };
+  bool converged = opt.targetReached(kpiStats());
+  while (!converged && (int)runs.size() < opt.maxReplications) {
+    launch(std::min(batch, opt.maxReplications - (int)runs.size()));
+    converged = opt.targetReached(kpiStats());
+  }
+
+  ReplicationResult res = summarizeReplications(runs, opt.confidence);
+  res.sequential = true;
+  res.converged = converged;
+  return res;
+}
@@ -0,0 +1,321 @@
+#include "schedule_generator.hpp"
+#include "rng.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using ShipPlan = SimulationConfig::ShipPlan;
+
+static const char *typeNames[] = {"BULK", "LIQUID", "CONTAINER"};
+static constexpr double kTwoPi = 6.283185307179586;
+
+static CargoType parseCargoType(const std::string &name) {
+  for (int t = 0; t < 3; ++t) {
+    if (name == typeNames[t])
+      return (CargoType)t;
+  }
+  throw std::invalid_argument("unknown cargo type: " + name);
+}
+
+// --- ArrivalProcess ---
+
+ArrivalProcess ArrivalProcess::from_json(const json &j) {
+  ArrivalProcess a;
+  std::string process = j.value("process", "poisson");
+  if (process == "poisson") {
+    a.kind = POISSON;
+  } else if (process == "piecewise") {
+    a.kind = PIECEWISE;
+  } else if (process == "batch") {
+    a.kind = BATCH;
+  } else {
+    throw std::invalid_argument("unknown arrival process: " + process);
+  }
+
+  if (a.kind == PIECEWISE) {
+    for (auto const &s : j.at("segments"))
+      a.segments.push_back({s.at("from"), s.at("perDay")});
+    if (a.segments.empty())
+      throw std::invalid_argument("piecewise arrivals need segments");
+    std::sort(a.segments.begin(), a.segments.end(),
+              [](const Segment &x, const Segment &y) { return x.from < y.from; });
+    if (j.contains("period")) a.period = j["period"];
+    if (a.period < 0 || (a.period > 0 && a.segments.back().from >= a.period))
+      throw std::invalid_argument("segments must start within the period");
+  } else {
+    a.perDay = j.at("perDay");
+  }
+
+  if (a.kind == BATCH) {
+    if (j.contains("batchSize")) {
+      a.batchMin = j["batchSize"].at(0);
+      a.batchMax = j["batchSize"].at(1);
+    }
+    if (j.contains("spread")) a.spread = j["spread"];
+    if (a.batchMin < 1 || a.batchMin > a.batchMax || a.spread < 0)
+      throw std::invalid_argument("invalid batch size or spread");
+  }
+
+  auto badRate = [](double perDay) {
+    return !std::isfinite(perDay) || perDay < 0;
+  };
+  if (badRate(a.perDay) ||
+      std::any_of(a.segments.begin(), a.segments.end(),
+                  [&](const Segment &s) { return badRate(s.perDay); }))
+    throw std::invalid_argument("arrival rate must be finite and non-negative");
+  return a;
+}
+
+double ArrivalProcess::rateAt(int t) const {
+  if (kind != PIECEWISE)
+    return perDay / tmux::DAY;
+
+  int local = period > 0 ? t % period : t;
+  auto it = std::upper_bound(
+      segments.begin(), segments.end(), local,
+      [](int time, const Segment &s) { return time < s.from; });
+  if (it == segments.begin()) {
+    // до первого сегмента: в сезонном режиме действует последний
+    return period > 0 ? segments.back().perDay / tmux::DAY : 0.0;
+  }
+  return (it - 1)->perDay / tmux::DAY;
+}
+
+int ArrivalProcess::nextChange(int t) const {
+  if (kind != PIECEWISE)
+    return std::numeric_limits<int>::max();
+
+  int base = period > 0 ? t - t % period : 0;
+  int local = t - base;
+  for (auto const &s : segments) {
+    if (s.from > local)
+      return base + s.from;
+  }
+  return period > 0 ? base + period : std::numeric_limits<int>::max();
+}
+
+// --- WeightDistribution ---
+
+WeightDistribution WeightDistribution::from_json(const json &j) {
+  WeightDistribution w;
+  std::string distribution = j.value("distribution", "lognormal");
+  if (distribution == "lognormal") {
+    w.kind = LOGNORMAL;
+    if (j.contains("median")) {
+      double median = j["median"];
+      if (median <= 0)
+        throw std::invalid_argument("median weight must be positive");
+      w.mu = std::log(median);
+    } else {
+      w.mu = j.at("mu");
+    }
+    w.sigma = j.value("sigma", 0.0);
+    if (w.sigma < 0)
+      throw std::invalid_argument("sigma must not be negative");
+  } else if (distribution == "empirical") {
+    w.kind = EMPIRICAL;
+    w.values = j.at("values").get<std::vector<int>>();
+    if (w.values.empty())
+      throw std::invalid_argument("empirical weights need values");
+    std::vector<double> p(w.values.size(), 1.0);
+    if (j.contains("probabilities")) {
+      p = j["probabilities"].get<std::vector<double>>();
+      if (p.size() != w.values.size())
+        throw std::invalid_argument("values and probabilities differ in size");
+    }
+    double sum = 0.0;
+    for (double x : p) {
+      if (x < 0)
+        throw std::invalid_argument("probabilities must not be negative");
+      sum += x;
+      w.cumulative.push_back(sum);
+    }
+    if (sum <= 0)
+      throw std::invalid_argument("probabilities sum to zero");
+  } else {
+    throw std::invalid_argument("unknown weight distribution: " + distribution);
+  }
+
+  if (j.contains("min")) w.min = j["min"];
+  if (j.contains("max")) w.max = j["max"];
+  if (w.min > w.max)
+    throw std::invalid_argument("min weight exceeds max weight");
+  return w;
+}
+
+int WeightDistribution::sample(double u1, double u2) const {
+  double x;
+  if (kind == LOGNORMAL) {
+    // Бокс — Мюллер
+    double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * u2);
+    x = std::exp(mu + sigma * z);
+  } else {
+    auto it = std::upper_bound(cumulative.begin(), cumulative.end(),
+                               u1 * cumulative.back());
+    x = values[std::min<std::size_t>(it - cumulative.begin(),
+                                     values.size() - 1)];
+  }
+  return (int)std::clamp<double>(std::round(x), min, max);
+}
+
+// --- ScheduleSpec ---
+
+ScheduleSpec ScheduleSpec::from_json(const json &j) {
+  ScheduleSpec s;
+  if (j.contains("seed")) s.seed = j["seed"];
+  if (j.contains("horizon")) s.horizon = j["horizon"];
+  if (s.horizon <= 0 || s.horizon > kMaxHorizon)
+    throw std::invalid_argument("horizon must be between 1 and " +
+                                std::to_string(kMaxHorizon) + " minutes");
+
+  // префиксы делают имена судов уникальными: заданные явно не должны
+  // совпадать, а по умолчанию берётся буква типа, если она ещё свободна,
+  // иначе буква с номером потока ("B1")
+  std::set<std::string> used;
+  std::vector<bool> defaulted;
+  for (auto const &js : j.at("streams")) {
+    CargoStream c;
+    c.type = parseCargoType(js.at("type"));
+    defaulted.push_back(!js.contains("prefix"));
+    if (!defaulted.back()) {
+      c.prefix = js["prefix"].get<std::string>();
+      if (!used.insert(c.prefix).second)
+        throw std::invalid_argument("duplicate stream prefix '" + c.prefix +
+                                    "'");
+    }
+    c.arrivals = ArrivalProcess::from_json(js.at("arrivals"));
+    c.weights = WeightDistribution::from_json(js.at("weight"));
+    s.streams.push_back(std::move(c));
+  }
+  for (std::size_t i = 0; i < s.streams.size(); ++i) {
+    if (!defaulted[i])
+      continue;
+    std::string letter(1, typeNames[(int)s.streams[i].type][0]);
+    std::string prefix =
+        used.count(letter) ? letter + std::to_string(i) : letter;
+    if (!used.insert(prefix).second)
+      throw std::invalid_argument("stream " + std::to_string(i) +
+                                  " needs an explicit prefix");
+    s.streams[i].prefix = prefix;
+  }
+
+  double expected = 0.0;
+  for (auto const &c : s.streams) {
+    auto const &a = c.arrivals;
+    double perDay = a.perDay;
+    if (a.kind == ArrivalProcess::PIECEWISE) {
+      perDay = 0.0;
+      for (auto const &seg : a.segments)
+        perDay = std::max(perDay, seg.perDay);
+    }
+    if (a.kind == ArrivalProcess::BATCH)
+      perDay *= a.batchMax;
+    expected += perDay * s.horizon / tmux::DAY;
+  }
+  if (expected > kMaxShips)
+    throw std::invalid_argument("schedule would have more than " +
+                                std::to_string((long long)kMaxShips) +
+                                " ships");
+  return s;
+}
+
+// --- генерация ---
+
+namespace {
+// Суда одного потока за сутки [begin, end).
+void generateDay(const ScheduleSpec &spec, int stream, int day, int begin,
+                 int end, std::vector<ShipPlan> &out) {
+  const CargoStream &cs = spec.streams[stream];
+  const ArrivalProcess &a = cs.arrivals;
+  RandomStream rs{spec.seed, (std::uint64_t(stream) << 32) | std::uint32_t(day),
+                  DrawPurpose::SCHEDULE};
+  std::uint32_t n = 0;
+  int number = 0;
+  std::string dayPrefix = cs.prefix + "-" + std::to_string(day) + "-";
+
+  auto emit = [&](int arrival) {
+    double u1 = rs.uniform(n++);
+    double u2 = rs.uniform(n++);
+    out.push_back({dayPrefix + std::to_string(number++), cs.type, arrival,
+                   cs.weights.sample(u1, u2)});
+  };
+
+  // Пуассон с кусочно-постоянной интенсивностью: на смене интенсивности
+  // розыгрыш начинается заново (отсутствие последействия)
+  double t = begin;
+  while (t < end) {
+    int from = (int)t;
+    double rate = a.rateAt(from);
+    int change = std::min(a.nextChange(from), end);
+    if (rate <= 0) {
+      t = change;
+      continue;
+    }
+    t += -std::log(rs.uniform(n++)) / rate;
+    if (t >= change) {
+      t = change;
+      continue;
+    }
+
+    int at = (int)t;
+    if (a.kind != ArrivalProcess::BATCH) {
+      emit(at);
+      continue;
+    }
+    int size = uniformInt(rs.uniform(n++), a.batchMin, a.batchMax);
+    for (int i = 0; i < size; ++i) {
+      int offset = uniformInt(rs.uniform(n++), 0, a.spread);
+      emit((int)std::min<long long>((long long)at + offset,
+                                    spec.horizon - 1));
+    }
+  }
+}
+} // namespace
+
+std::vector<ShipPlan> generateSchedule(const ScheduleSpec &spec,
+                                       ThreadPool &pool) {
+  int days = (int)(((long long)spec.horizon + tmux::DAY - 1) / tmux::DAY);
+
+  std::vector<std::future<std::vector<ShipPlan>>> pending;
+  pending.reserve(days);
+  for (int day = 0; day < days; ++day) {
+    pending.push_back(pool.submit([&spec, day] {
+      int begin = day * tmux::DAY;
+      int end = std::min(begin + tmux::DAY, spec.horizon);
+      std::vector<ShipPlan> ships;
+      for (int s = 0; s < (int)spec.streams.size(); ++s)
+        generateDay(spec, s, day, begin, end, ships);
+      std::stable_sort(ships.begin(), ships.end(),
+                       [](const ShipPlan &x, const ShipPlan &y) {
+                         return x.arrival < y.arrival;
+                       });
+      return ships;
+    }));
+  }
+
+  std::vector<std::vector<ShipPlan>> parts;
+  std::exception_ptr error;
+  for (auto &f : pending) {
+    try {
+      parts.push_back(f.get());
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+
+  std::size_t total = 0;
+  for (auto const &p : parts)
+    total += p.size();
+  std::vector<ShipPlan> schedule;
+  schedule.reserve(total);
+  for (auto &p : parts)
+    std::move(p.begin(), p.end(), std::back_inserter(schedule));
+  return schedule;
+}
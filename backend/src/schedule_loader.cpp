@@ -0,0 +1,451 @@
+#include "schedule_loader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using ShipPlan = SimulationConfig::ShipPlan;
+
+ScheduleFormat scheduleFormatFromName(const std::string &name) {
+  std::string s = name;
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](unsigned char ch) { return std::tolower(ch); });
+  if (s == "csv")
+    return ScheduleFormat::CSV;
+  if (s == "ndjson" || s == "jsonl")
+    return ScheduleFormat::NDJSON;
+  if (s.empty() || s == "auto")
+    return ScheduleFormat::AUTO;
+  throw std::invalid_argument("unknown schedule format: " + name);
+}
+
+namespace {
+
+// Файл, отображённый в память только для чтения.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("cannot open file");
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("cannot stat file");
+    }
+    size = (std::size_t)st.st_size;
+    if (size > 0) {
+      void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("cannot map file");
+      }
+      ::madvise(p, size, MADV_WILLNEED);
+      data = static_cast<const char *>(p);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+      throw std::runtime_error("cannot open file");
+    fallback.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    data = fallback.data();
+    size = fallback.size();
+#endif
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (data != nullptr)
+      ::munmap(const_cast<char *>(data), size);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view view() const { return {data, size}; }
+
+private:
+  const char *data = nullptr;
+  std::size_t size = 0;
+#ifdef _WIN32
+  std::string fallback;
+#endif
+};
+
+// Ошибка разбора с позицией в файле; номер строки считается уже после,
+// в вызывающем потоке.
+struct ParseError : std::runtime_error {
+  std::size_t offset;
+  ParseError(std::size_t at, const std::string &what)
+      : std::runtime_error(what), offset(at) {}
+};
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+    s.remove_prefix(1);
+  while (!s.empty() &&
+         (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+    s.remove_suffix(1);
+  return s;
+}
+
+CargoType parseType(std::string_view s, std::size_t at) {
+  s = trim(s);
+  if (s == "BULK")
+    return CargoType::BULK;
+  if (s == "LIQUID")
+    return CargoType::LIQUID;
+  if (s == "CONTAINER")
+    return CargoType::CONTAINER;
+  throw ParseError(at, "unknown cargo type");
+}
+
+// Значение поля в int: за пределами int приведение было бы неопределённым.
+int toInt(double d, std::size_t at, const char *field) {
+  d = std::round(d);
+  if (!(d >= std::numeric_limits<int>::min() &&
+        d <= std::numeric_limits<int>::max()))
+    throw ParseError(at, std::string(field) + " out of range");
+  return (int)d;
+}
+
+int parseInt(std::string_view s, std::size_t at, const char *field) {
+  s = trim(s);
+  int value = 0;
+  auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  if (ec == std::errc() && end == s.data() + s.size())
+    return value;
+
+  // дробные значения и экспонента — через strtod
+  std::string copy(s);
+  char *stop = nullptr;
+  double d = std::strtod(copy.c_str(), &stop);
+  if (copy.empty() || *stop != '\0' || !std::isfinite(d))
+    throw ParseError(at, std::string("bad ") + field);
+  return toInt(d, at, field);
+}
+
+// --- CSV ---
+
+enum Column { NAME, TYPE, ARRIVAL, WEIGHT };
+
+struct CsvLayout {
+  int column[4] = {NAME, TYPE, ARRIVAL, WEIGHT};
+  int fields = 4;
+  bool header = false;
+};
+
+// Поля строки CSV; кавычки снимаются, "" внутри кавычек — одна кавычка.
+void splitCsv(std::string_view line, std::vector<std::string> &out) {
+  out.clear();
+  std::string field;
+  bool quoted = false;
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    char ch = line[i];
+    if (quoted) {
+      if (ch == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        field.push_back('"');
+        ++i;
+      } else if (ch == '"') {
+        quoted = false;
+      } else {
+        field.push_back(ch);
+      }
+    } else if (ch == '"') {
+      quoted = true;
+    } else if (ch == ',') {
+      out.push_back(std::move(field));
+      field.clear();
+    } else {
+      field.push_back(ch);
+    }
+  }
+  out.push_back(std::move(field));
+}
+
+CsvLayout detectLayout(std::string_view firstLine) {
+  static const char *names[] = {"name", "type", "arrival", "weight"};
+  CsvLayout layout;
+  std::vector<std::string> fields;
+  splitCsv(firstLine, fields);
+
+  int found[4] = {-1, -1, -1, -1};
+  for (int i = 0; i < (int)fields.size(); ++i) {
+    std::string f(trim(fields[i]));
+    std::transform(f.begin(), f.end(), f.begin(),
+                   [](unsigned char ch) { return std::tolower(ch); });
+    for (int c = 0; c < 4; ++c) {
+      if (f == names[c])
+        found[c] = i;
+    }
+  }
+  if (std::all_of(found, found + 4, [](int i) { return i >= 0; })) {
+    layout.header = true;
+    layout.fields = (int)fields.size();
+    std::copy(found, found + 4, layout.column);
+  }
+  return layout;
+}
+
+void parseCsvLine(std::string_view line, std::size_t at,
+                  const CsvLayout &layout, std::vector<std::string> &fields,
+                  std::vector<ShipPlan> &out) {
+  splitCsv(line, fields);
+  if ((int)fields.size() < layout.fields)
+    throw ParseError(at, "expected " + std::to_string(layout.fields) +
+                             " fields, got " + std::to_string(fields.size()));
+  ShipPlan plan;
+  plan.name = std::string(trim(fields[layout.column[NAME]]));
+  plan.type = parseType(fields[layout.column[TYPE]], at);
+  plan.arrival = parseInt(fields[layout.column[ARRIVAL]], at, "arrival");
+  plan.weight = parseInt(fields[layout.column[WEIGHT]], at, "weight");
+  out.push_back(std::move(plan));
+}
+
+// --- NDJSON ---
+
+// Быстрый разбор плоского объекта со строковыми и числовыми значениями.
+// Возвращает false, если строка сложнее (экранирование, вложенность и т.п.),
+// тогда её разбирает nlohmann::json.
+bool parseFlatObject(std::string_view s, std::size_t at, ShipPlan &plan,
+                     unsigned &seen) {
+  std::size_t i = 0;
+  auto ws = [&] {
+    while (i < s.size() && std::isspace((unsigned char)s[i]))
+      ++i;
+  };
+  auto str = [&](std::string_view &out) {
+    if (i >= s.size() || s[i] != '"')
+      return false;
+    std::size_t start = ++i;
+    while (i < s.size() && s[i] != '"') {
+      if (s[i] == '\\')
+        return false;
+      ++i;
+    }
+    if (i >= s.size())
+      return false;
+    out = s.substr(start, i - start);
+    ++i;
+    return true;
+  };
+
+  ws();
+  if (i >= s.size() || s[i] != '{')
+    return false;
+  ++i;
+  for (;;) {
+    ws();
+    if (i < s.size() && s[i] == '}')
+      break;
+    std::string_view key, value;
+    if (!str(key))
+      return false;
+    ws();
+    if (i >= s.size() || s[i] != ':')
+      return false;
+    ++i;
+    ws();
+    bool isString = i < s.size() && s[i] == '"';
+    if (isString) {
+      if (!str(value))
+        return false;
+    } else {
+      std::size_t start = i;
+      while (i < s.size() && (std::isdigit((unsigned char)s[i]) ||
+                              std::strchr("+-.eE", s[i]) != nullptr))
+        ++i;
+      if (i == start)
+        return false;
+      value = s.substr(start, i - start);
+    }
+
+    if (key == "name" && isString) {
+      plan.name = std::string(value);
+      seen |= 1u << NAME;
+    } else if (key == "type" && isString) {
+      plan.type = parseType(value, at);
+      seen |= 1u << TYPE;
+    } else if (key == "arrival" && !isString) {
+      plan.arrival = parseInt(value, at, "arrival");
+      seen |= 1u << ARRIVAL;
+    } else if (key == "weight" && !isString) {
+      plan.weight = parseInt(value, at, "weight");
+      seen |= 1u << WEIGHT;
+    } else if (key == "name" || key == "type" || key == "arrival" ||
+               key == "weight") {
+      return false;
+    }
+
+    ws();
+    if (i < s.size() && s[i] == ',') {
+      ++i;
+      continue;
+    }
+    if (i < s.size() && s[i] == '}')
+      break;
+    return false;
+  }
+  ++i;
+  ws();
+  return i == s.size();
+}
+
+void parseJsonLine(std::string_view line, std::size_t at,
+                   std::vector<ShipPlan> &out) {
+  ShipPlan plan;
+  unsigned seen = 0;
+  if (!parseFlatObject(line, at, plan, seen)) {
+    try {
+      auto j = json::parse(line);
+      plan.name = j.at("name").get<std::string>();
+      plan.type = parseType(j.at("type").get<std::string>(), at);
+      plan.arrival = toInt(j.at("arrival").get<double>(), at, "arrival");
+      plan.weight = toInt(j.at("weight").get<double>(), at, "weight");
+      seen = 0xf;
+    } catch (json::exception &) {
+      // текст исключения цитирует строку файла — его не пересказываем
+      throw ParseError(at, "expected a JSON object with name, type, arrival, weight");
+    }
+  }
+  if (seen != 0xf)
+    throw ParseError(at, "expected fields name, type, arrival, weight");
+  out.push_back(std::move(plan));
+}
+
+// Разбор куска [begin, end) файла; границы кусков совпадают с началами строк.
+std::vector<ShipPlan> parseChunk(std::string_view text, std::size_t begin,
+                                 std::size_t end, ScheduleFormat format,
+                                 const CsvLayout &layout) {
+  std::vector<ShipPlan> out;
+  out.reserve((end - begin) / 32);
+  std::vector<std::string> fields;
+
+  std::size_t pos = begin;
+  while (pos < end) {
+    const char *nl = static_cast<const char *>(
+        std::memchr(text.data() + pos, '\n', end - pos));
+    std::size_t stop = nl ? (std::size_t)(nl - text.data()) : end;
+    std::string_view line = trim(text.substr(pos, stop - pos));
+    if (!line.empty()) {
+      if (format == ScheduleFormat::CSV)
+        parseCsvLine(line, pos, layout, fields, out);
+      else
+        parseJsonLine(line, pos, out);
+    }
+    pos = stop + 1;
+  }
+  return out;
+}
+
+ScheduleFormat formatFromPath(const std::string &path) {
+  auto dot = path.rfind('.');
+  std::string ext = dot == std::string::npos ? "" : path.substr(dot + 1);
+  ScheduleFormat f = ScheduleFormat::AUTO;
+  try {
+    f = scheduleFormatFromName(ext);
+  } catch (std::invalid_argument &) {
+  }
+  if (f == ScheduleFormat::AUTO)
+    throw std::invalid_argument(
+        "cannot tell schedule format from file extension, expected .csv or "
+        ".ndjson");
+  return f;
+}
+
+} // namespace
+
+std::vector<ShipPlan> loadSchedule(const std::string &path,
+                                   ScheduleFormat format, ThreadPool &pool) {
+  if (format == ScheduleFormat::AUTO)
+    format = formatFromPath(path);
+
+  MappedFile file(path);
+  std::string_view text = file.view();
+  std::size_t body = 0;
+
+  CsvLayout layout;
+  if (format == ScheduleFormat::CSV && !text.empty()) {
+    std::size_t nl = text.find('\n');
+    layout = detectLayout(text.substr(0, nl));
+    if (layout.header)
+      body = nl == std::string_view::npos ? text.size() : nl + 1;
+  }
+
+  // куски не меньше мегабайта, по нескольку на поток
+  constexpr std::size_t kMinChunk = 1 << 20;
+  std::size_t chunks = std::max<std::size_t>(
+      1, std::min<std::size_t>(pool.size() * 4,
+                               (text.size() - body) / kMinChunk));
+  std::vector<std::size_t> bounds{body};
+  for (std::size_t k = 1; k < chunks; ++k) {
+    std::size_t pos = body + (text.size() - body) * k / chunks;
+    pos = std::max(pos, bounds.back());
+    std::size_t nl = text.find('\n', pos);
+    bounds.push_back(nl == std::string_view::npos ? text.size() : nl + 1);
+  }
+  bounds.push_back(text.size());
+
+  std::vector<std::future<std::vector<ShipPlan>>> pending;
+  for (std::size_t k = 0; k + 1 < bounds.size(); ++k) {
+    std::size_t begin = bounds[k], end = bounds[k + 1];
+    pending.push_back(pool.submit([text, begin, end, format, &layout] {
+      return parseChunk(text, begin, end, format, layout);
+    }));
+  }
+
+  // файл отображён до выхода из функции, поэтому дожидаемся всех кусков
+  std::vector<std::vector<ShipPlan>> parts;
+  std::exception_ptr error;
+  std::size_t errorAt = 0;
+  std::string errorText;
+  for (auto &f : pending) {
+    try {
+      parts.push_back(f.get());
+    } catch (ParseError &e) {
+      if (!error) {
+        error = std::current_exception();
+        errorAt = e.offset;
+        errorText = e.what();
+      }
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (!errorText.empty()) {
+    auto line = 1 + std::count(text.begin(), text.begin() + errorAt, '\n');
+    throw std::runtime_error("line " + std::to_string(line) + ": " +
+                             errorText);
+  }
+  if (error)
+    std::rethrow_exception(error);
+
+  std::size_t total = 0;
+  for (auto const &p : parts)
+    total += p.size();
+  std::vector<ShipPlan> schedule;
+  schedule.reserve(total);
+  for (auto &p : parts)
+    std::move(p.begin(), p.end(), std::back_inserter(schedule));
+  return schedule;
+}
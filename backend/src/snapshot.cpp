@@ -0,0 +1,282 @@
+#include "binary_io.hpp"
+#include "journal.hpp"
+#include "port.hpp"
+#include <stdexcept>
+
+// Формат снимка: сигнатура и версия, скаляры модели, суда, краны, очереди
+// и запланированные окончания разгрузки. Порядок прибытий и пулы свободных
+// кранов однозначно выводятся из остального и при restore строятся заново.
+// Генератор счётчиковый, поэтому его состояние — только зерно.
+static constexpr std::uint32_t kSnapshotMagic = 0x54525053; // "SPRT"
+static constexpr std::uint8_t kSnapshotVersion = 1;
+
+static void putQueue(BinaryWriter &w, ShipQueue q) {
+  w.putVarint(q.size());
+  for (; !q.empty(); q.pop())
+    w.putVarint(q.front());
+}
+
+static ShipQueue getQueue(BinaryReader &r, int ships) {
+  ShipQueue q;
+  for (auto n = r.getVarint(); n > 0; --n) {
+    auto idx = r.getVarint();
+    if (idx >= (std::uint64_t)ships)
+      throw std::runtime_error("snapshot: ship id out of range");
+    q.push((int)idx);
+  }
+  return q;
+}
+
+// Счётчики из снимка должны сходиться с состояниями судов и очередями:
+// по ним считается штраф и решается, закончен ли прогон.
+void Port::checkRestoredCounters() const {
+  int queued[3] = {0, 0, 0};
+  int started = 0;
+  int finished = 0;
+  for (int i = 0; i < ships.size(); ++i) {
+    switch (ships.state[i]) {
+    case ShipState::QUEUED:
+      queued[(int)ships.type[i]]++;
+      break;
+    case ShipState::FINISHED:
+      ++finished;
+      ++started;
+      break;
+    case ShipState::UNLOADING:
+      ++started;
+      break;
+    default:
+      break;
+    }
+  }
+  const ShipQueue *queues[3] = {&qBulk, &qLiquid, &qContainer};
+  for (int t = 0; t < 3; ++t) {
+    if (waiting[t] != queued[t] || (int)queues[t]->size() != queued[t])
+      throw std::runtime_error("snapshot: queues do not match ship states");
+    for (ShipQueue q = *queues[t]; !q.empty(); q.pop()) {
+      int idx = q.front();
+      if ((int)ships.type[idx] != t ||
+          ships.state[idx] != ShipState::QUEUED)
+        throw std::runtime_error("snapshot: queues do not match ship states");
+    }
+  }
+  if (startedCount != started || finishedCount != finished ||
+      (int)completions.size() != started - finished)
+    throw std::runtime_error("snapshot: counters do not match ship states");
+}
+
+std::string Port::snapshot() const {
+  BinaryWriter w;
+  w.put(kSnapshotMagic);
+  w.put(kSnapshotVersion);
+
+  w.putSigned(now);
+  w.put(fine);
+  for (double f : fineByType)
+    w.put(f);
+  w.put(rngSeed);
+  w.put<std::uint8_t>(antithetic);
+  w.putVarint(arrivalCursor);
+  w.putVarint(startedCount);
+  w.putVarint(finishedCount);
+  for (int n : waiting)
+    w.putVarint(n);
+
+  w.putVarint(ships.size());
+  for (int i = 0; i < ships.size(); ++i) {
+    auto const &info = ships.info[i];
+    w.putString(info.name);
+    w.putSigned(info.arrival);
+    w.putSigned(info.weight);
+    w.putSigned(ships.actualArrival[i]);
+    w.putSigned(ships.unloadTime[i]);
+    w.putSigned(ships.startUnload[i]);
+    w.put(ships.type[i]);
+    w.put(ships.state[i]);
+  }
+
+  w.putVarint(cranes.size());
+  for (auto const &c : cranes) {
+    w.put(c.type);
+    w.put<std::uint8_t>(c.busy);
+    w.putSigned(c.busyUntil);
+    w.putSigned(c.busyMinutes);
+  }
+
+  putQueue(w, qBulk);
+  putQueue(w, qLiquid);
+  putQueue(w, qContainer);
+
+  auto pending = completions;
+  w.putVarint(pending.size());
+  for (; !pending.empty(); pending.pop()) {
+    auto const &c = pending.top();
+    w.putSigned(c.time);
+    w.putVarint(c.ship);
+    w.putVarint(c.crane);
+  }
+  return std::move(w.buffer);
+}
+
+void Port::restore(const std::string &data) {
+  if (cfg == nullptr)
+    throw std::logic_error("restore: config is not set");
+
+  BinaryReader r(data);
+  if (r.get<std::uint32_t>() != kSnapshotMagic)
+    throw std::runtime_error("snapshot: bad signature");
+  if (r.get<std::uint8_t>() != kSnapshotVersion)
+    throw std::runtime_error("snapshot: unsupported version");
+
+  // читаем во временный объект, чтобы при ошибке текущее состояние уцелело
+  Port p;
+  p.cfg = cfg;
+  p.plans = plans;
+  p.logEvents = logEvents;
+  p.journal = journal;
+  p.trace = trace;
+
+  p.now = (int)r.getSigned();
+  p.fine = r.get<double>();
+  for (double &f : p.fineByType)
+    f = r.get<double>();
+  p.rngSeed = r.get<std::uint64_t>();
+  p.antithetic = r.get<std::uint8_t>() != 0;
+  p.arrivalCursor = r.getVarint();
+  p.startedCount = (int)r.getVarint();
+  p.finishedCount = (int)r.getVarint();
+  for (int &n : p.waiting)
+    n = (int)r.getVarint();
+
+  auto shipCount = r.getVarint();
+  for (std::uint64_t i = 0; i < shipCount; ++i) {
+    ShipInfo info;
+    info.name = r.getString();
+    info.arrival = (int)r.getSigned();
+    info.weight = (int)r.getSigned();
+    int actualArrival = (int)r.getSigned();
+    int unloadTime = (int)r.getSigned();
+    int id = p.ships.add(std::move(info), CargoType::BULK, actualArrival,
+                         unloadTime);
+    p.ships.startUnload.mut(id) = (int)r.getSigned();
+    p.ships.type.mut(id) = r.get<CargoType>();
+    p.ships.state.mut(id) = r.get<ShipState>();
+    if ((int)p.ships.type[id] > 2 || (int)p.ships.state[id] > 3)
+      throw std::runtime_error("snapshot: bad ship record");
+  }
+
+  for (auto n = r.getVarint(); n > 0; --n) {
+    Crane c;
+    c.type = r.get<CargoType>();
+    c.busy = r.get<std::uint8_t>() != 0;
+    c.busyUntil = (int)r.getSigned();
+    c.busyMinutes = r.getSigned();
+    if ((int)c.type > 2)
+      throw std::runtime_error("snapshot: bad crane record");
+    p.cranes.push_back(c);
+  }
+
+  p.qBulk = getQueue(r, p.ships.size());
+  p.qLiquid = getQueue(r, p.ships.size());
+  p.qContainer = getQueue(r, p.ships.size());
+
+  for (auto n = r.getVarint(); n > 0; --n) {
+    Completion c;
+    c.time = (int)r.getSigned();
+    // номера проверяем до приведения к int, как в getQueue
+    auto ship = r.getVarint();
+    auto crane = r.getVarint();
+    if (ship >= (std::uint64_t)p.ships.size() ||
+        crane >= (std::uint64_t)p.cranes.size())
+      throw std::runtime_error("snapshot: bad completion record");
+    c.ship = (int)ship;
+    c.crane = (int)crane;
+    p.completions.push(c);
+  }
+  if (!r.atEnd() || p.arrivalCursor > (std::size_t)p.ships.size())
+    throw std::runtime_error("snapshot: trailing or inconsistent data");
+  p.checkRestoredCounters();
+
+  p.sortArrivals();
+  p.rebuildFreeCranes();
+  // после restore клиентам нужно полное состояние
+  p.version = p.layoutVersion = version + 1;
+  *this = std::move(p);
+  if (journal != nullptr)
+    journal->begin(*this);
+}
+
+void Port::reconfigure(const SimulationConfig *conf) {
+  int want[3] = {conf->cranesBulk, conf->cranesLiquid, conf->cranesContainer};
+  int have[3] = {0, 0, 0};
+  int idle[3] = {0, 0, 0};
+  for (auto const &c : cranes) {
+    have[(int)c.type]++;
+    idle[(int)c.type] += !c.busy;
+  }
+  for (int t = 0; t < 3; ++t) {
+    if (want[t] < 0 || have[t] - want[t] > idle[t])
+      throw std::invalid_argument("reconfigure: cannot remove busy cranes");
+  }
+  cfg = conf;
+  ++version;
+
+  // лишние свободные краны убираются с конца, номера остальных сдвигаются
+  std::vector<int> remap(cranes.size(), -1);
+  std::vector<Crane> kept;
+  // краны убраны или добавлены — номера кранов у клиентов устарели
+  bool relaid = false;
+  int extra[3];
+  for (int t = 0; t < 3; ++t)
+    extra[t] = std::max(0, have[t] - want[t]);
+  for (int i = (int)cranes.size() - 1; i >= 0; --i) {
+    auto const &c = cranes[i];
+    if (!c.busy && extra[(int)c.type] > 0) {
+      extra[(int)c.type]--;
+      remap[i] = -2;
+      relaid = true;
+    }
+  }
+  for (int i = 0; i < (int)cranes.size(); ++i) {
+    if (remap[i] == -2)
+      continue;
+    remap[i] = (int)kept.size();
+    kept.push_back(cranes[i]);
+  }
+  for (int t = 0; t < 3; ++t) {
+    for (int n = have[t]; n < want[t]; ++n) {
+      kept.push_back({(CargoType)t, false, 0, 0});
+      relaid = true;
+    }
+  }
+  if (relaid)
+    layoutVersion = version;
+  cranes = std::move(kept);
+
+  std::vector<Completion> pending;
+  for (; !completions.empty(); completions.pop()) {
+    Completion c = completions.top();
+    c.crane = remap[c.crane];
+    pending.push_back(c);
+  }
+  for (auto const &c : pending)
+    completions.push(c);
+
+  for (int i = 0; i < ships.size(); ++i) {
+    if (ships.startUnload[i] != kNoTime)
+      continue;
+    auto const &info = ships.info[i];
+    std::uint64_t key = shipStreamKey(info.name, info.arrival, info.weight,
+                                      (int)ships.type[i]);
+    int unload = computeUnloadTime(ships.type[i], info.weight, key);
+    // не трогаем совпадающие значения, чтобы не копировать общие блоки
+    if (unload != ships.unloadTime[i]) {
+      ships.unloadTime.mut(i) = unload;
+      touchShip(i);
+    }
+  }
+
+  rebuildFreeCranes();
+  if (journal != nullptr)
+    journal->begin(*this);
+}
@@ -0,0 +1,139 @@
+#include "state_stream.hpp"
+#include "port.hpp"
+#include <algorithm>
+
+// Кадр SSE. id есть только у кадров состояния — это их версия: по ней
+// браузер при переподключении присылает Last-Event-ID и получает только
+// пропущенное.
+static std::string frame(const char *event, const std::string &data,
+                         std::uint64_t id = 0) {
+  std::string out;
+  if (id != 0)
+    out += "id: " + std::to_string(id) + "\n";
+  out += "event: ";
+  out += event;
+  out += "\ndata: ";
+  out += data;
+  out += "\n\n";
+  return out;
+}
+
+std::shared_ptr<StateStream::Subscriber>
+StateStream::subscribe(std::uint64_t since) {
+  auto sub = std::make_shared<Subscriber>();
+  sub->version = since;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  subscribers.push_back(sub);
+  return sub;
+}
+
+void StateStream::unsubscribe(const std::shared_ptr<Subscriber> &sub) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscribers.erase(
+        std::remove(subscribers.begin(), subscribers.end(), sub),
+        subscribers.end());
+  }
+  std::lock_guard<std::mutex> lock(sub->mutex);
+  sub->closed = true;
+  sub->cv.notify_all();
+}
+
+void StateStream::publish(const char *event, const std::string &data) {
+  std::vector<std::string> events;
+  if (event != nullptr)
+    events.push_back(frame(event, data));
+  bool done = port.done();
+  if (done && !wasDone)
+    events.push_back(frame("done", "{}"));
+  wasDone = done;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto const &sub : subscribers) {
+    {
+      std::lock_guard<std::mutex> subLock(sub->mutex);
+      sub->dirty = true;
+      for (auto const &e : events) {
+        if (sub->events.size() == kMaxEvents)
+          sub->events.pop_front();
+        sub->events.push_back(e);
+      }
+    }
+    sub->cv.notify_all();
+  }
+}
+
+bool StateStream::next(Subscriber &sub, std::string &out,
+                       std::chrono::milliseconds timeout) {
+  auto takeEvents = [&] {
+    for (auto const &e : sub.events)
+      out += e;
+    sub.events.clear();
+  };
+
+  bool dirty;
+  {
+    std::unique_lock<std::mutex> lock(sub.mutex);
+    sub.cv.wait_for(lock, timeout, [&] {
+      return sub.closed || sub.dirty || !sub.events.empty();
+    });
+    if (sub.closed)
+      return false;
+    dirty = sub.dirty;
+    if (!dirty)
+      takeEvents();
+  }
+
+  if (dirty) {
+    // sub.mutex отпущен на время ожидания порта: publish берёт его под
+    // portMutex. События забираем уже под portMutex — это ровно те, что
+    // опубликованы до отдаваемой версии, и они уходят перед ней.
+    std::lock_guard<std::mutex> lock(portMutex);
+    {
+      std::lock_guard<std::mutex> subLock(sub.mutex);
+      takeEvents();
+      sub.dirty = false;
+    }
+    if (port.version != sub.version) {
+      if (cacheVersion != port.version) {
+        cache.clear();
+        cacheVersion = port.version;
+      }
+      // после перестройки всем отстающим уходит одно и то же полное состояние
+      std::uint64_t since = sub.version;
+      if (since < port.layoutVersion || since > port.version)
+        since = 0;
+      auto &text = cache[since];
+      if (!text)
+        text = std::make_shared<const std::string>(
+            frame("state", port.getState(since).dump(), port.version));
+      out += *text;
+      sub.version = port.version;
+    }
+  }
+
+  if (out.empty()) {
+    // комментарий SSE: держит соединение и выявляет ушедших клиентов
+    out += ": ping\n\n";
+  }
+  return true;
+}
+
+std::size_t StateStream::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return subscribers.size();
+}
+
+void StateStream::close() {
+  std::vector<std::shared_ptr<Subscriber>> subs;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    subs.swap(subscribers);
+  }
+  for (auto const &sub : subs) {
+    std::lock_guard<std::mutex> lock(sub->mutex);
+    sub->closed = true;
+    sub->cv.notify_all();
+  }
+}
@@ -0,0 +1,192 @@
+#include "sweep.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+int SweepSpec::pointCount() const {
+  long long n = 1;
+  for (auto const &axis : axes)
+    n = std::min<long long>(n * (long long)axis.values.size(), kMaxPoints + 1);
+  return (int)n;
+}
+
+void SweepSpec::validate(const SimulationConfig &base) const {
+  json fields = base.to_json();
+  for (auto const &axis : axes) {
+    if (axis.field == "schedule" || !fields.contains(axis.field))
+      throw std::invalid_argument("unknown config field: " + axis.field);
+  }
+}
+
+static std::vector<json> rangeValues(const json &r) {
+  double from = r.at("from");
+  double to = r.at("to");
+  double step = r.value("step", 1.0);
+  if (!std::isfinite(from) || !std::isfinite(to) || !std::isfinite(step))
+    throw std::invalid_argument("sweep range bounds must be finite");
+  if (step <= 0)
+    throw std::invalid_argument("sweep range step must be positive");
+
+  // число значений считаем заранее, а не шагаем до to
+  double span = std::floor((to - from) / step + 1e-9);
+  if (span < 0)
+    return {};
+  if (span >= SweepSpec::kMaxAxisValues)
+    throw std::invalid_argument("sweep range has more than " +
+                                std::to_string(SweepSpec::kMaxAxisValues) +
+                                " values");
+  int count = (int)span + 1;
+
+  bool integral = r.at("from").is_number_integer() &&
+                  r.at("to").is_number_integer() &&
+                  (!r.contains("step") || r["step"].is_number_integer());
+
+  std::vector<json> values;
+  values.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    double v = from + i * step;
+    if (integral)
+      values.emplace_back((long long)std::llround(v));
+    else
+      values.emplace_back(v);
+  }
+  return values;
+}
+
+SweepSpec SweepSpec::from_json(const json &j) {
+  SweepSpec spec;
+  // каждая точка прогоняется ровно replications раз: последовательной
+  // остановки в переборе нет, и её параметры не принимаются молча
+  for (const char *key :
+       {"targetHalfWidth", "targetRelative", "kpi", "batch", "maxReplications"}) {
+    if (j.contains(key))
+      throw std::invalid_argument(std::string("sweep does not support '") +
+                                  key + "'; use a fixed replications count");
+  }
+  spec.replication = ReplicationOptions::from_json(j);
+
+  if (j.contains("grid")) {
+    for (auto const &item : j["grid"].items()) {
+      SweepAxis axis;
+      axis.field = item.key();
+      auto const &v = item.value();
+      if (v.is_array()) {
+        for (auto const &x : v)
+          axis.values.push_back(x);
+      } else if (v.is_object()) {
+        axis.values = rangeValues(v);
+      } else {
+        axis.values.push_back(v);
+      }
+      if (axis.values.empty())
+        throw std::invalid_argument("sweep axis '" + axis.field +
+                                    "' has no values");
+      if (axis.values.size() > (std::size_t)kMaxAxisValues)
+        throw std::invalid_argument("sweep axis '" + axis.field +
+                                    "' has more than " +
+                                    std::to_string(kMaxAxisValues) + " values");
+      spec.axes.push_back(std::move(axis));
+      if (spec.pointCount() > kMaxPoints)
+        throw std::invalid_argument("sweep grid has more than " +
+                                    std::to_string(kMaxPoints) + " points");
+    }
+  }
+  if ((long long)spec.pointCount() * spec.replication.replications > kMaxRuns)
+    throw std::invalid_argument("sweep has more than " +
+                                std::to_string(kMaxRuns) +
+                                " runs (points x replications)");
+  return spec;
+}
+
+json SweepPoint::to_json() const {
+  return {{"index", index}, {"params", params}, {"result", result.to_json()}};
+}
+
+namespace {
+struct PointState {
+  SimulationConfig cfg;
+  json params;
+  std::vector<RunSummary> runs;
+  std::atomic<int> left{0};
+};
+} // namespace
+
+void runSweep(const SimulationConfig &base, const SweepSpec &spec,
+              const std::function<void(const SweepPoint &)> &onPoint,
+              const std::atomic<bool> *cancel, ThreadPool &pool) {
+  spec.validate(base);
+  json scalars = base.to_json();
+  scalars.erase("schedule");
+
+  int points = spec.pointCount();
+  int reps = spec.replication.replications;
+  if (reps <= 0)
+    return;
+
+  // точки строятся без расписания: все прогоны читают base.schedule
+  std::vector<std::unique_ptr<PointState>> states;
+  states.reserve(points);
+  for (int p = 0; p < points; ++p) {
+    auto st = std::make_unique<PointState>();
+    json j = scalars;
+    st->params = json::object();
+    int rest = p;
+    for (int a = (int)spec.axes.size() - 1; a >= 0; --a) {
+      auto const &axis = spec.axes[a];
+      int n = (int)axis.values.size();
+      j[axis.field] = axis.values[rest % n];
+      st->params[axis.field] = axis.values[rest % n];
+      rest /= n;
+    }
+    st->cfg = SimulationConfig::from_json(j);
+    st->runs.resize(reps);
+    st->left = reps;
+    states.push_back(std::move(st));
+  }
+
+  auto cancelled = [cancel] { return cancel != nullptr && cancel->load(); };
+
+  std::mutex callbackMutex;
+  std::vector<std::future<void>> pending;
+  pending.reserve((std::size_t)points * reps);
+  for (int p = 0; p < points; ++p) {
+    for (int r = 0; r < reps; ++r) {
+      pending.push_back(pool.submit([&, p, r] {
+        auto &st = *states[p];
+        if (!cancelled()) {
+          st.runs[r] =
+              runReplication(st.cfg, replicationSeed(st.cfg.seed, r),
+                             spec.replication.until, &base.schedule);
+        }
+        if (st.left.fetch_sub(1) != 1 || cancelled())
+          return;
+
+        SweepPoint point;
+        point.index = p;
+        point.params = st.params;
+        point.result =
+            summarizeReplications(st.runs, spec.replication.confidence);
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        onPoint(point);
+      }));
+    }
+  }
+
+  // все задачи ссылаются на локальные states, поэтому дожидаемся каждой
+  // и только потом пробрасываем первую ошибку
+  std::exception_ptr error;
+  for (auto &f : pending) {
+    try {
+      f.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
@@ -0,0 +1,124 @@
+#include "trace.hpp"
+#include "port.hpp"
+#include <cstdio>
+
+static const char *typeNames[] = {"BULK", "LIQUID", "CONTAINER"};
+
+// микросекунды шкалы трассы на минуту модели
+static constexpr long long kMinute = 60LL * 1000 * 1000;
+
+// дорожка 0 — прибытия, кран i — дорожка i + 1
+static constexpr int kArrivalsTrack = 0;
+
+static void appendEscaped(std::string &out, const std::string &s) {
+  for (unsigned char ch : s) {
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+      out += (char)ch;
+    } else if (ch < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof buf, "\\u%04x", ch);
+      out += buf;
+    } else {
+      out += (char)ch;
+    }
+  }
+}
+
+TraceWriter::TraceWriter(Sink sink, std::size_t chunkSize)
+    : sink(std::move(sink)), chunkSize(chunkSize) {
+  buffer.reserve(chunkSize + 256);
+}
+
+void TraceWriter::begin(const Port &port) {
+  if (!open) {
+    buffer += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    buffer += "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+              "\"args\":{\"name\":\"Порт\"}}";
+    open = true;
+  }
+  // строки метаданных собираются в std::string: у snprintf в буфер
+  // фиксированного размера длинные записи обрезались бы
+  auto thread = [this](int tid, const std::string &name) {
+    std::string id = std::to_string(tid);
+    buffer += ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" + id +
+              ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+    appendEscaped(buffer, name);
+    buffer += "\"}}";
+    buffer += ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" + id +
+              ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":" +
+              id + "}}";
+  };
+  thread(kArrivalsTrack, "Прибытия");
+  for (int i = 0; i < (int)port.cranes.size(); ++i) {
+    thread(i + 1, "Кран " + std::to_string(i) + " · " +
+                      typeNames[(int)port.cranes[i].type]);
+  }
+  for (int &d : lastDepth)
+    d = -1;
+  maybeFlush();
+}
+
+void TraceWriter::event(const char *ph, int tid, int t) {
+  buffer += ",\n{\"ph\":\"";
+  buffer += ph;
+  buffer += "\",\"pid\":1,\"tid\":" + std::to_string(tid) +
+            ",\"ts\":" + std::to_string(t * kMinute);
+  ++count;
+}
+
+void TraceWriter::arrive(int t, const std::string &ship, CargoType type) {
+  event("i", kArrivalsTrack, t);
+  buffer += ",\"s\":\"t\",\"cat\":\"arrival\",\"name\":\"";
+  appendEscaped(buffer, ship);
+  buffer += "\",\"args\":{\"type\":\"";
+  buffer += typeNames[(int)type];
+  buffer += "\"}}";
+  maybeFlush();
+}
+
+void TraceWriter::startUnload(int t, int crane, const std::string &ship) {
+  event("B", crane + 1, t);
+  buffer += ",\"cat\":\"unload\",\"name\":\"";
+  appendEscaped(buffer, ship);
+  buffer += "\"}";
+  maybeFlush();
+}
+
+void TraceWriter::finishUnload(int t, int crane) {
+  event("E", crane + 1, t);
+  buffer += '}';
+  maybeFlush();
+}
+
+void TraceWriter::queues(int t, const int depth[3]) {
+  for (int i = 0; i < 3; ++i) {
+    if (depth[i] == lastDepth[i])
+      continue;
+    lastDepth[i] = depth[i];
+    char rec[160];
+    std::snprintf(rec, sizeof rec,
+                  ",\n{\"ph\":\"C\",\"pid\":1,\"ts\":%lld,"
+                  "\"name\":\"Очередь %s\",\"args\":{\"depth\":%d}}",
+                  t * kMinute, typeNames[i], depth[i]);
+    buffer += rec;
+    ++count;
+  }
+  maybeFlush();
+}
+
+void TraceWriter::close() {
+  if (!open)
+    return;
+  buffer += "\n]}\n";
+  open = false;
+  sink(buffer);
+  buffer.clear();
+}
+
+void TraceWriter::maybeFlush() {
+  if (buffer.size() < chunkSize)
+    return;
+  sink(buffer);
+  buffer.clear();
+}
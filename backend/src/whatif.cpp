@@ -0,0 +1,65 @@
+#include "whatif.hpp"
+#include <future>
+#include <memory>
+
+json WhatIfResult::to_json() const {
+  return {{"name", name}, {"summary", summary.to_json()}};
+}
+
+std::vector<WhatIfResult> runWhatIf(const Port &origin,
+                                    const std::vector<WhatIfBranch> &branches,
+                                    int until, ThreadPool &pool) {
+  // копии снимаются здесь, пока origin гарантированно не меняется
+  std::vector<std::unique_ptr<Port>> ports;
+  ports.reserve(branches.size());
+  for (std::size_t i = 0; i < branches.size(); ++i) {
+    ports.push_back(std::make_unique<Port>(origin));
+    ports.back()->logEvents = false;
+    ports.back()->journal = nullptr;
+    ports.back()->trace = nullptr;
+  }
+
+  std::vector<std::future<WhatIfResult>> pending;
+  pending.reserve(branches.size());
+  for (std::size_t i = 0; i < branches.size(); ++i) {
+    auto const &branch = branches[i];
+    Port &port = *ports[i];
+    pending.push_back(pool.submit([&branch, &port, until] {
+      port.reconfigure(&branch.cfg);
+
+      WhatIfResult res;
+      res.name = branch.name;
+      long long events =
+          port.run(until, std::numeric_limits<long long>::max());
+      res.summary = port.summarize();
+      res.summary.events = events;
+      return res;
+    }));
+  }
+
+  std::vector<WhatIfResult> results;
+  results.reserve(pending.size());
+  std::exception_ptr error;
+  for (auto &f : pending) {
+    try {
+      results.push_back(f.get());
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return results;
+}
+
+std::vector<WhatIfResult> runWhatIf(const std::string &snapshot,
+                                    const std::vector<WhatIfBranch> &branches,
+                                    int until, ThreadPool &pool) {
+  if (branches.empty())
+    return {};
+  Port origin;
+  origin.setConfig(&branches.front().cfg);
+  origin.restore(snapshot);
+  return runWhatIf(origin, branches, until, pool);
+}
@@ -15,17 +15,66 @@ export async function saveConfig(config: any) {
 }
 
 
-export const getState = async () => {
-    const res = await fetch(`${API_URL}/state`);
+// t — прошедший момент симуляции (восстанавливается по журналу на сервере)
+export const getState = async (t?: number) => {
+    const res = await fetch(t === undefined ? `${API_URL}/state` : `${API_URL}/state?t=${t}`);
     return res.json();
 };
 
-export const stepSimulation = async () => {
-    const res = await fetch(`${API_URL}/step`, { method: "POST" });
+// since — версия уже полученного состояния: сервер вернёт только изменения
+export const getStateSince = async (since: number) => {
+    const res = await fetch(`${API_URL}/state?since=${since}`);
+    return res.json();
+};
+
+export const stepSimulation = async (since?: number) => {
+    const res = await fetch(since === undefined ? `${API_URL}/step` : `${API_URL}/step?since=${since}`,
+        { method: "POST" });
+    return res.json();
+};
+
+export const runSimulation = async (options: { until?: number; maxEvents?: number } = {}) => {
+    const res = await fetch(`${API_URL}/run`, {
+        method: "POST",
+        headers: { "Content-Type": "application/json" },
+        body: JSON.stringify(options),
+    });
+    return res.json();
+};
+
+// Автопрогон на сервере: speed — минут модели в секунду
+export const startAutorun = async (speed: number, stepsPerTick = 1) => {
+    const res = await fetch(`${API_URL}/autorun`, {
+        method: "POST",
+        headers: { "Content-Type": "application/json" },
+        body: JSON.stringify({ speed, stepsPerTick }),
+    });
+    return res.json();
+};
+
+export const getAutorun = async () => {
+    const res = await fetch(`${API_URL}/autorun`);
+    return res.json();
+};
+
+export const pauseAutorun = async () => {
+    const res = await fetch(`${API_URL}/pause`, { method: "POST" });
     return res.json();
 };
 
 export const resetSimulation = async () => {
     const res = await fetch(`${API_URL}/reset`, { method: "POST" });
     return res.json();
-};
\ No newline at end of file
+};
+
+// Поток изменений состояния (Server-Sent Events): "state" — дельты состояния
+// (как у getStateSince), "reset", "config", "restore", "done" — события
+// жизненного цикла. При обрыве EventSource переподключается сам и получает
+// только пропущенное.
+export const subscribeEvents = (handlers: Record<string, (data: any) => void>) => {
+    const source = new EventSource(`${API_URL}/events`);
+    for (const [event, handler] of Object.entries(handlers)) {
+        source.addEventListener(event, (e) => handler(JSON.parse((e as MessageEvent).data)));
+    }
+    return source;
+};
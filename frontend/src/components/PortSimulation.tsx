@@ -3,10 +3,13 @@ import {
     Play, RotateCcw, StepForward,
     Clock, DollarSign, Ship, Hammer, Droplets, Package, Scale, Loader, Waves, TextQuote, BookText, FileDown
 } from "lucide-react";
-import { getState, stepSimulation, resetSimulation } from "../api/portApi";
+import {
+    stepSimulation, resetSimulation, subscribeEvents, startAutorun, pauseAutorun, getAutorun
+} from "../api/portApi";
 import { motion, AnimatePresence } from "framer-motion";
 
 interface ShipData {
+    id: number;
     name: string;
     type: string;
     arrival: number;
@@ -24,14 +27,19 @@ interface ShipData {
 }
 
 interface Crane {
+    id: number;
     type: string;
     busy: boolean;
     busyUntil: number;
 }
 
 interface PortState {
+    version: number;
+    full: boolean;
     now: number;
     fine: number;
+    finePerMinute: number;
+    step: number;
     ships: ShipData[];
     cranes: Crane[];
     queueBulk: number;
@@ -39,6 +47,38 @@ interface PortState {
     queueContainer: number;
 }
 
+// Сервер на шаге присылает только изменившиеся суда и краны (или всё при
+// full); остальные берутся из прежнего состояния, а зависящие от времени
+// поля пересчитываются по новому now.
+const mergeState = (prev: PortState | null, delta: PortState): PortState => {
+    if (!prev || delta.full) return delta;
+
+    const changedShips = new Map(delta.ships.map(s => [s.id, s]));
+    const changedCranes = new Map(delta.cranes.map(c => [c.id, c]));
+    const now = delta.now;
+
+    const ships = prev.ships.map(old => {
+        const s = changedShips.get(old.id) ?? old;
+        return {
+            ...s,
+            timeToArrival: Math.max(0, s.actualArrival - now),
+            timeToFinish: s.unloading && s.finish > now ? s.finish - now : 0,
+            currentFine: s.inQueue && s.actualArrival <= now
+                ? (now - s.actualArrival) * delta.finePerMinute : 0,
+        };
+    });
+    const cranes = prev.cranes.map(c => changedCranes.get(c.id) ?? c);
+
+    return { ...delta, ships, cranes };
+};
+
+const formatTime = (m: number) => {
+    const d = Math.floor(m / 1440);
+    const h = Math.floor((m % 1440) / 60);
+    const min = m % 60;
+    return `${d}д ${h}ч ${min}м`;
+};
+
 const PortSimulation: React.FC = () => {
     const [state, setState] = useState<PortState | null>(null);
     const [running, setRunning] = useState(false);
@@ -47,53 +87,70 @@ const PortSimulation: React.FC = () => {
     const [showPopup, setShowPopup] = useState(false);
     const [finalStats, setFinalStats] = useState<string | null>(null);
 
-    // @ts-ignore
-    const intervalRef = useRef<NodeJS.Timeout | null>(null);
     const seenEvents = useRef<Set<string>>(new Set());
+    // последнее собранное состояние: к нему применяются дельты шагов
+    const stateRef = useRef<PortState | null>(null);
+
+    const replaceState = (s: PortState) => {
+        stateRef.current = s;
+        setState(s);
+    };
 
+    // состояние приходит только из потока /events: первым кадром полное,
+    // дальше дельты после каждого шага — чьего угодно, не только этой вкладки
     useEffect(() => {
-        getState().then(setState);
+        const source = subscribeEvents({
+            state: (delta: PortState) => updateWithEvent(delta),
+            reset: () => clearRun(),
+            config: () => clearRun(),
+            restore: () => clearRun(),
+            autorun: () => setRunning(true),
+            pause: () => setRunning(false),
+        });
+        getAutorun().then(s => setRunning(s.running));
+        return () => source.close();
     }, []);
 
+    // ответы шагов не нужны: изменения придут событием, поэтому просим
+    // только дельту
     const handleStep = async () => {
-        const newState = await stepSimulation();
-        updateWithEvent(newState);
+        await stepSimulation(stateRef.current?.version);
     };
 
-    const handleReset = async () => {
+    const clearRun = () => {
         setRunning(false);
-        if (intervalRef.current) clearInterval(intervalRef.current);
-        const resetState = await resetSimulation();
-        setState(resetState);
         setLog([]);
         setShowPopup(false);
         setFinalStats(null);
         seenEvents.current.clear();
+        loggedEvents.current.clear();
     };
 
-    const toggleRun = () => setRunning((prev) => !prev);
+    const handleReset = async () => {
+        clearRun();
+        await resetSimulation();
+    };
 
-    useEffect(() => {
-        if (running) {
-            if (intervalRef.current) clearInterval(intervalRef.current);
-            intervalRef.current = setInterval(async () => {
-                const newState = await stepSimulation();
-                updateWithEvent(newState);
-            }, 1000 / speed);
-        } else {
-            if (intervalRef.current) clearInterval(intervalRef.current);
-            intervalRef.current = null;
-        }
-        return () => {
-            if (intervalRef.current) clearInterval(intervalRef.current);
-        };
-    }, [running, speed]);
+    // шаги автопрогона делает сервер; скорость N× — N шагов модели в секунду,
+    // кнопка и её состояние следуют событиям autorun/pause
+    const autorunSpeed = (x: number) => x * (stateRef.current?.step ?? 1);
+
+    const toggleRun = () => {
+        if (running) pauseAutorun();
+        else startAutorun(autorunSpeed(speed));
+    };
+
+    const changeSpeed = (x: number) => {
+        setSpeed(x);
+        if (running) startAutorun(autorunSpeed(x));
+    };
 
     const loggedEvents = useRef<Set<string>>(new Set());
 
-    const updateWithEvent = (newState: PortState) => {
-        const prev = state;
-        setState(newState);
+    const updateWithEvent = (delta: PortState) => {
+        const prev = stateRef.current;
+        const newState = mergeState(prev, delta);
+        replaceState(newState);
         if (!prev) return;
 
         const logOnce = (key: string, msg: string) => {
@@ -131,8 +188,6 @@ const PortSimulation: React.FC = () => {
 
         const allDone = newState.ships.every(s => s.finished);
         if (allDone) {
-            setRunning(false);
-            if (intervalRef.current) clearInterval(intervalRef.current);
 
             const finished = newState.ships.filter(s => s.finished);
             const total = finished.length;
@@ -166,13 +221,6 @@ const PortSimulation: React.FC = () => {
         </div>;
     }
 
-    const formatTime = (m: number) => {
-        const d = Math.floor(m / 1440);
-        const h = Math.floor((m % 1440) / 60);
-        const min = m % 60;
-        return `${d}д ${h}ч ${min}м`;
-    };
-
     const cargoColor = (t: string) => ({
         BULK: "bg-yellow-100 border-yellow-400",
         LIQUID: "bg-blue-100 border-blue-400",
@@ -214,7 +262,7 @@ const PortSimulation: React.FC = () => {
 
                     <div className="flex items-center gap-2 ml-auto">
                         <span className="text-gray-700 text-sm font-medium">Скорость:</span>
-                        <select value={speed} onChange={(e) => setSpeed(Number(e.target.value))}
+                        <select value={speed} onChange={(e) => changeSpeed(Number(e.target.value))}
                                 className="border rounded-lg px-3 py-1 text-sm">
                             {[1, 2, 5, 10, 15, 50, 100].map(v => <option key={v} value={v}>{v}x</option>)}
                         </select>